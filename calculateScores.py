@@ -6,7 +6,7 @@ input
 - nModels: number of neural networks in the ensemble
 
 
-loads simulations from format_simulations.py
+loads simulations from format_simulations.py, or the image batch written directly by the models (see simulationBatch.py)
 loads the formated image (here, modelPredictions/base.npy)
 projects the image and the simulations into low-dimensional space using the neural networks
 takes the euclidean distance between each simulation and the image
@@ -17,12 +17,13 @@ adds these scores to fittingInfo/allScores.csv (which tracks the scores for all
 
 import numpy as np
 from sn_snModel import loadModel
+from simulationBatch import loadBatch
 import sys
 import os
 
 nModels = int(sys.argv[1])
 
-modelSimulations = np.load('modelPredictions/simulations.npy', allow_pickle=True)
+modelSimulations, ready = loadBatch('modelPredictions/simulations.npy')
 shape = [len(modelSimulations)]
 for i in modelSimulations.shape:
     shape.append(i)
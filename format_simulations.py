@@ -1,5 +1,6 @@
 '''
 same as formatData.py, but formats the simulations used in the parameter estimation steps
+simulations run with --image already contain image.npy, which is used directly instead of the csv files
 '''
 
 
@@ -11,12 +12,16 @@ import sys
 
 nSims = int(sys.argv[1])
 gridSize = int(sys.argv[2])
-imSize = (int(sys.argv[3],int(sys.argv[3]))
+imSize = (int(sys.argv[3]),int(sys.argv[3]))
 bindingLayer = 0
 
 sims = []
 for i in range(nSims):
-    layers = loadSingle('modelPredictions/simulation_'+str(i)+'/set_0')
+    fld = 'modelPredictions/simulation_'+str(i)+'/set_0'
+    if os.path.exists(fld+'/image.npy'):
+        sims.append(np.load(fld+'/image.npy'))
+        continue
+    layers = loadSingle(fld)
     ds = DiscreteImg(gridSize, layers, bindingLayer)
     sg = ds.smallGrids(imSize)
 
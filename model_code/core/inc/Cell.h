@@ -0,0 +1,207 @@
+#ifndef IMMUNE_MODEL_CELL_H
+#define IMMUNE_MODEL_CELL_H
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <random>
+#include <limits>
+#include <string>
+#include <iostream>
+#include "RandomStream.h"
+#include "FirstTouch.h"
+
+/*
+ * precision of cell positions and forces
+ * compiled with -DSINGLE_PRECISION they are stored and computed as float, halving the memory traffic of the force loops
+ * probabilities, parameters, and sums over many cells stay double
+ */
+#ifdef SINGLE_PRECISION
+typedef float real;
+#else
+typedef double real;
+#endif
+
+struct CellTypeParams{
+    /*
+     * parameters shared by every cell of a type, built once from cellParams
+     * cells point to their type's block and only store what differs between cells
+     * filled by the model's cellTypes (Models.h), fields a model does not use stay 0
+     */
+
+    int type;
+
+    // physical properties
+    double radius;
+    double rmax;
+    double mu;
+    double kc;
+    double damping;
+    double maxOverlap;
+
+    // division and lifespan
+    double divProb;
+    double deathProb;
+
+    // migration, infiltration depth is drawn per cell from a half-normal with this sd
+    double migrationSpeed;
+    double migrationBias;
+    double infiltrationSD;
+
+    // interactions with other cells
+    double killProb;
+    double influenceRadius;
+    double influenceDec;
+    double pdl1WhenExpressed;
+    double pdl1Shift;
+    double probTh;
+
+    // hypoxic core radius and the hourly death probability inside it
+    double hypoxicL;
+    double hypoxicP;
+};
+
+struct StepProbabilities{
+    /*
+     * per-type probabilities of the constant-rate events over one step, 1 - (1 - p)^tstep of the hourly p
+     * the environment rebuilds them when the step size changes, so a cell event is one draw and one comparison
+     */
+    double tstep = -1;
+    double division = 0;
+    double death = 0;
+    double kill = 0;
+    double hypoxia = 0;
+};
+
+template<int Dim>
+class Cell{
+public:
+    /*
+     * Dim = 2 or 3, positions and vectors only hold the components that exist
+     * their components are real (float or double, see above)
+     * explicit instantiations are at the bottom of the Cell_*.cpp files
+     */
+    using Vec = std::array<real, Dim>;
+
+    /*
+     * FUNCTIONS
+     */
+
+    // initialization
+    Cell(Vec loc, int idx, const CellTypeParams *params, double time, uint64_t seed);
+    Cell() = default;
+    void initializeCancerCell();
+    void initializeCD8Cell();
+
+    // force functions
+    Vec attractiveForce(const Vec &dx, double otherRadius);
+    Vec repulsiveForce(const Vec &dx, double otherRadius);
+    void calculateForces(const Vec &otherX, double otherRadius, int &otherType);
+    void resolveForces(double dt);
+    void resetForces();
+    bool isNeighbor(const Vec &otherX);
+    bool inContact(const Vec &otherX, double otherRadius);
+
+    // overlap functions
+    void calculateOverlap(const Vec &otherX, double otherRadius);
+    void resetOverlap();
+    void isCompressed();
+
+    // cell behavior functions
+    std::array<double, Dim+1> proliferate(double pDivision);
+    void age(double pDeath);
+    void migrate(double dt, const std::vector<Vec> &edgeCells, const Vec &tumorCenter);
+
+    // cell influences
+    void addInfluence(const Vec &otherX, double otherInfluence, int otherType);
+    void clearInfluence();
+
+    // CD8 specific
+    void pdl1Inhibition(double pInhibit, uint64_t otherLineage);
+    bool kills(double pKill, uint64_t otherLineage);
+
+    // cancer specific
+    void prolifState();
+    void inherit(double pd);
+    void gainPDL1(double dt);
+    void dieFromHypoxia(const Vec &tumorCenter, double pHypoxia);
+
+    // type parameters, suppressed CD8 (state 2) lose their killing and migration and have a reduced influence
+    double radius() const {return typeParams->radius;}
+    double killProb() const {return state == 2 ? 0.0 : typeParams->killProb;}
+    double influenceRadius() const {return state == 2 ? typeParams->influenceRadius*typeParams->influenceDec : typeParams->influenceRadius;}
+    double migrationSpeed() const {return state == 2 ? 0.0 : typeParams->migrationSpeed;}
+
+    // other functions
+    double calcDistance(const Vec &otherX);
+    void updateID(int idx);
+    void writeState(std::ostream &out) const;
+    void readState(std::istream &in);
+    void reseed(uint64_t seed);
+    void useCommonRandomNumbers(uint64_t seed);
+    void useEventTimers(bool on);
+    void resetEventTimers();
+    double calcInfDistance(double dist, double xth);
+    static double calcNorm(const Vec &dx);
+    static double probTime(double pInit, double dt);
+
+    /*
+     * PARAMETERS
+     */
+
+    // shared parameters of this cell's type, not stored in checkpoints
+    const CellTypeParams *typeParams;
+
+    // location
+    Vec x;
+
+    // physical properties
+    bool compressed;
+    double currentOverlap;
+    // this cell's neighbors are Environment::neighborIndices[neighborStart, neighborStart+neighborCount)
+    int neighborStart;
+    int neighborCount;
+
+    // division
+    bool canProlif;
+
+    // force properties
+    Vec currentForces;
+
+    // migration
+    double infiltrationDistance;
+
+    // interactions with other cells
+    double pdl1;
+    // by the state of the influencing cell
+    std::array<double, 3> influences;
+
+    // identification
+    int id;
+    int type;
+    int state;
+    double timeBorn;
+    // stable across shuffles, daughters and recruits get ids derived from their origin
+    uint64_t lineage;
+    // simulation step, keys the common random number draws
+    int currentStep;
+    // with event timers, draw opportunities left before the next death and division, -1 until sampled
+    int deathCountdown;
+    int divisionCountdown;
+
+private:
+    double draw(crn::Event event, uint64_t n = 0);
+    double pairDraw(crn::Event event, uint64_t keyLineage, uint64_t n);
+    bool eventDue(int &countdown, crn::Event event, double p);
+    bool eventTimers;
+
+    SplitMix64 rng;
+    bool commonRandom;
+    uint64_t crnSeed;
+};
+
+// the environment's cell list, its pages are first touched by the threads that process them
+template<int Dim>
+using CellList = FirstTouchVector<Cell<Dim>>;
+
+#endif //IMMUNE_MODEL_CELL_H
@@ -0,0 +1,61 @@
+#ifndef IMMUNE_MODEL_CHECKPOINT_H
+#define IMMUNE_MODEL_CHECKPOINT_H
+
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <string>
+#include <thread>
+#include <functional>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+
+/*
+ * raw binary read/write used for checkpoints
+ * only for trivially copyable types, so the bytes on disk are the exact in-memory state
+ */
+
+template<typename T>
+inline void writeBinary(std::ostream &out, const T &value){
+    static_assert(std::is_trivially_copyable<T>::value, "writeBinary -> type must be trivially copyable");
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+inline void readBinary(std::istream &in, T &value){
+    static_assert(std::is_trivially_copyable<T>::value, "readBinary -> type must be trivially copyable");
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if(!in){
+        throw std::runtime_error("readBinary -> checkpoint ended early");
+    }
+}
+
+/*
+ * files are written under a temporary name next to their destination and then published
+ * the name is private to the writing process and thread, so runs sharing a folder never write the same file
+ */
+
+inline std::string writerTmpName(const std::string &file){
+    return file+".tmp."+std::to_string(getpid())+"."+std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+// moves tmp onto file, without replace an existing file wins, tmp is removed and false returned
+inline bool publishFile(const std::string &tmp, const std::string &file, bool replace){
+    if(replace){
+        if(std::rename(tmp.c_str(), file.c_str()) != 0){
+            std::remove(tmp.c_str());
+            throw std::runtime_error("publishFile -> unable to replace "+file);
+        }
+        return true;
+    }
+    // link fails if file exists, so of several writers exactly one publishes
+    int linked = link(tmp.c_str(), file.c_str());
+    int error = errno;
+    std::remove(tmp.c_str());
+    if(linked == 0){return true;}
+    if(error == EEXIST){return false;}
+    throw std::runtime_error("publishFile -> unable to create "+file);
+}
+
+#endif //IMMUNE_MODEL_CHECKPOINT_H
@@ -0,0 +1,83 @@
+#ifndef IMMUNE_MODEL_COREFIELD_H
+#define IMMUNE_MODEL_COREFIELD_H
+
+#include <array>
+#include <vector>
+#include <iostream>
+#include "Cell.h"
+
+/*
+ * HYBRID CORE
+ * -----------
+ * deep in a large tumor the cancer cells are compressed, they neither divide nor meet CD8,
+ * and only matter through the space they fill
+ * with RunOptions::coreDepth set, space is cut into square (cubic) bins of binSize um, and bins deep enough
+ * inside the tumor hold their cancer cells as counts instead of as cells (the core)
+ * every bin is either held or not, cells in held bins are absorbed, so the two never overlap
+ * the environment steps the counts and couples them to the cells around (environmentCore.cpp)
+ *
+ * bins are numbered by floor(x/binSize) from the origin, the grid is the block of bins that covers the tumor
+ * and is moved as it grows, held bins keep their number and their random numbers (key)
+ */
+
+struct CoreBin{
+    // cells held as counts, and how many the bin holds before they are compressed
+    int alive;
+    int dead;
+    int capacity;
+    // summed PD-L1 and birth time of the living cells, held cells carry the mean
+    double pdl1;
+    double born;
+    bool held;
+};
+
+template<int Dim>
+class CoreField{
+public:
+    using Vec = typename Cell<Dim>::Vec;
+    using Index = std::array<int, Dim>;
+
+    CoreField();
+    void clear();
+    // grid covering the ball (center, reach), held bins keep their counts
+    void cover(const Vec &center, double reach, double width);
+
+    int size() const {return static_cast<int>(bins.size());}
+    bool empty() const {return numHeld == 0;}
+    // bin containing x, -1 outside the grid
+    int find(const Vec &x) const;
+    // as find, but -1 unless the bin is held
+    int heldAt(const Vec &x) const;
+    Index index(int b) const;
+    Vec binCenter(int b) const;
+    // closest point of bin b to x and its distance, 0 inside the bin
+    double boxDistance(int b, const Vec &x, Vec &nearest) const;
+    // closest held bin among the bins next to the one containing x, -1 if there is none
+    int nearestHeld(const Vec &x, Vec &nearest, double &distance) const;
+    // bins of the grid within distance of x
+    void near(const Vec &x, double distance, std::vector<int> &found) const;
+    // keys the random numbers of bin b, the same wherever the grid is
+    uint64_t key(int b) const;
+
+    // bin b joins the core with room for capacity cells, or the cells absorbed so far if more, and leaves it empty
+    void hold(int b, int capacity);
+    void drop(int b);
+    // a cancer cell joins bin b
+    void absorb(int b, const Cell<Dim> &cell);
+    // number of held cells, and the sum of their positions (bin centers)
+    int cells() const;
+    void positionSum(std::array<double, Dim> &sum) const;
+
+    void write(std::ostream &out) const;
+    void read(std::istream &in);
+
+    std::vector<CoreBin> bins;
+    double binSize;
+    int numHeld;
+
+private:
+    Index first;
+    Index extent;
+};
+
+#endif //IMMUNE_MODEL_COREFIELD_H
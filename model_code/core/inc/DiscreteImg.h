@@ -0,0 +1,37 @@
+#ifndef IMMUNE_MODEL_DISCRETEIMG_H
+#define IMMUNE_MODEL_DISCRETEIMG_H
+
+#include <array>
+#include <vector>
+#include <string>
+
+/*
+ * C++ version of data_discretizeFunctions.DiscreteImg
+ * ---------------------------------------------------
+ * bins cell layers onto a grid bound to bindingLayer, then shrinks the grid to imSize x imSize
+ * shrinking follows cv2.resize(..., interpolation=cv2.INTER_AREA), and each channel is scaled to a max of 1
+ *
+ * layers: one list per image channel, each point is [x, y, value]
+ * grids are stored row-major as (rows, cols, layers), matching the numpy arrays of the python version
+ */
+
+class DiscreteImg{
+public:
+    DiscreteImg(double gridSize, std::vector<std::vector<std::array<double, 3>>> layers, int bindingLayer);
+
+    std::vector<double> createGrids(int &sizeX, int &sizeY);
+    std::vector<double> smallGrids(int imSize, std::vector<size_t> &shape);
+
+    static void saveNpy(std::string file, const std::vector<double> &data, const std::vector<size_t> &shape);
+    static void saveNpySlot(std::string file, size_t slot, size_t nSlots, const std::vector<double> &data, const std::vector<size_t> &shape, char flag);
+
+private:
+    void scaleLayers(double size);
+    static std::string npyHeader(const std::vector<size_t> &shape);
+    static std::vector<double> resizeArea(const std::vector<double> &src, int rows, int cols, int cn, int dRows, int dCols);
+
+    std::vector<std::vector<std::array<double, 3>>> scaledLayers;
+    int bl;
+};
+
+#endif //IMMUNE_MODEL_DISCRETEIMG_H
@@ -0,0 +1,57 @@
+#ifndef IMMUNE_MODEL_DOMAIN_H
+#define IMMUNE_MODEL_DOMAIN_H
+
+#include <vector>
+
+/*
+ * DOMAIN DECOMPOSITION
+ * --------------------
+ * built with -DUSE_MPI and started under mpirun with more than one rank, a simulation is split into slabs along x
+ * rank r owns the cells between the (r-1)-th and r-th cut in x, the first and last slab are unbounded
+ * the cuts are placed at equal shares of the cells and moved once a day as the tumor grows (balance)
+ * the environment exchanges cells between ranks as byte buffers, this class only moves the bytes
+ * without USE_MPI, or with a single rank, there is one slab and every call is a no-op or a copy
+ *
+ * MPI is started once per program (start/stop), environments then pick up MPI_COMM_WORLD on construction
+ * programs that never call start (replicates, the GA driver) keep every environment on a single rank
+ */
+
+class Domain{
+public:
+    static void start(int &argc, char **&argv);
+    static void stop();
+
+    Domain();
+    int rank() const {return myRank;}
+    int size() const {return numRanks;}
+    bool distributed() const {return numRanks > 1;}
+
+    // rank owning position x, and the ranks whose slabs lie within width of x, first to last
+    int owner(double x) const;
+    void ranksNear(double x, double width, int &first, int &last) const;
+    // new cuts at equal shares of the positions held by all ranks
+    void balance(const std::vector<double> &x);
+
+    // element-wise over all ranks, in place
+    void sum(double *values, int n) const;
+    void sum(int *values, int n) const;
+    void max(double *values, int n) const;
+    // rank 0's value on every rank
+    int broadcast(int value) const;
+    void broadcast(std::vector<char> &bytes) const;
+
+    // send[r] goes to rank r, recv[r] is what rank r sent here
+    void exchange(const std::vector<std::vector<char>> &send, std::vector<std::vector<char>> &recv) const;
+    // every rank's bytes joined in rank order, on rank 0 (gather) or on all ranks (allGather)
+    void gather(const std::vector<char> &mine, std::vector<char> &all) const;
+    void allGather(const std::vector<char> &mine, std::vector<char> &all) const;
+    void barrier() const;
+
+private:
+    int myRank;
+    int numRanks;
+    // numRanks-1 inner cuts, slab r is [cuts[r-1], cuts[r])
+    std::vector<double> cuts;
+};
+
+#endif //IMMUNE_MODEL_DOMAIN_H
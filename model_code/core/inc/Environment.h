@@ -0,0 +1,373 @@
+#ifndef IMMUNE_MODEL_ENVIRONMENT_H
+#define IMMUNE_MODEL_ENVIRONMENT_H
+
+#include <vector>
+#include <algorithm>
+#include <random>
+#include "Models.h"
+#include "Domain.h"
+#include "CoreField.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <array>
+#include <omp.h>
+
+class StoppingCriterion;
+
+struct NeighborSpan{
+    // one cell's slice of the shared neighbor buffer
+    const int *first;
+    const int *last;
+    const int *begin() const {return first;}
+    const int *end() const {return last;}
+};
+
+struct PopulationCounts{
+    /*
+     * number of cells per type (0 cancer, 1 CD8) and state (-1 dead, 0 cancer, 1 active CD8, 2 suppressed CD8)
+     * kept up to date by the environment on birth, recruitment, death, removal, and suppression,
+     * so count queries do not scan the cell list
+     */
+    std::array<std::array<int, 4>, 2> n{};
+
+    int total(int type) const {return n[type][0] + n[type][1] + n[type][2] + n[type][3];}
+    int of(int type, int state) const {return n[type][state+1];}
+    void add(int type, int state, int k = 1){n[type][state+1] += k;}
+    void move(int type, int from, int to, int k = 1){n[type][from+1] -= k; n[type][to+1] += k;}
+};
+
+struct Parameters{
+    /*
+     * the three parameter files of a run
+     * read-only once loaded, so replicates of one parameter set share a single copy
+     */
+    std::vector<std::vector<double>> cellParams;
+    std::vector<double> recParams;
+    std::vector<double> envParams;
+
+    // per-type blocks every cell points to (0 cancer, 1 CD8), built by the model
+    std::array<CellTypeParams, 2> cellTypes;
+
+    template<class Model>
+    static std::shared_ptr<const Parameters> load(std::string paramDir){
+        std::shared_ptr<Parameters> params = read(paramDir);
+        params->cellTypes = Model::cellTypes(params->cellParams);
+        return params;
+    }
+    static std::shared_ptr<Parameters> read(std::string paramDir);
+};
+
+struct RunOptions{
+    // per-step and per-day progress output
+    bool verbose = true;
+
+    // number of cells at which the OpenMP loops switch from serial to parallel execution
+    // below it a simulation stays on one core, so several simulations can share a machine
+    int parallelThreshold = 500;
+
+    // days between checkpoints written to saveDir/checkpoint.bin, 0 turns checkpointing off
+    int checkpointInterval = 0;
+
+    // folder of pre-grown tumors shared between runs, empty turns the cache off
+    // burnInSample picks one of several cached tumors for the same parameters
+    std::string burnInCache;
+    int burnInSample = 0;
+
+    // final image written to saveDir/image.npy when imageGridSize > 0
+    // same layers as parseData.loadSingle, binned with DiscreteImg (gridSize in um, imSize pixels)
+    double imageGridSize = 0;
+    int imageSize = 0;
+
+    // with imageBatch set, the image goes to slot imageSlot of a shared (imageSlots, imSize, imSize, 4) .npy instead
+    std::string imageBatch;
+    int imageSlot = 0;
+    int imageSlots = 0;
+
+    // common random numbers: stochastic events draw from hashes keyed by (crnSeed, cell lineage, event, step)
+    // runs with the same seed at nearby parameters then share their random numbers (see RandomStream.h)
+    bool commonRandomNumbers = false;
+    uint64_t crnSeed = 0;
+
+    // fidelity level L trades accuracy for speed: tstep and the mechanical dt are scaled by 2^L,
+    // neighbor lists are rebuilt every 2^L steps, and edge cells every 2^L days (0 is full fidelity)
+    int fidelity = 0;
+    // cells farther than domainCutoff (um) outside the tumor radius are removed, 0 keeps every cell
+    // CD8 are kept up to at least 2 recDist outside, where recruits arrive, so the cut-off only drops strays
+    double domainCutoff = 0;
+
+    // the tumor center moves every step with the cancer cells, and the radius is kept as an upper bound between days
+    // dailyTumorCenter keeps both fixed for the day instead, as in runs from before the per-step update
+    bool dailyTumorCenter = false;
+    // days between searches for edge cells (scaled by 2^fidelity), the center and radius are exact once a day regardless
+    int edgeInterval = 1;
+
+    // loops over neighbor and contact lists split the cells into per-thread ranges of about equal work,
+    // staticChunks splits them into ranges of equal cell counts instead (as schedule(static))
+    bool staticChunks = false;
+    // each thread's busy time in those loops is written to saveDir/threadBalance.csv
+    bool threadTiming = false;
+
+    // death and division come from a geometric waiting time sampled once per event instead of a draw every step
+    // statistically equivalent, but runs differ draw for draw from runs without it
+    bool eventTimers = false;
+
+    // hybrid core: cancer cells more than coreDepth um inside the edge cells, and out of every CD8's reach,
+    // are held as counts on a grid instead of as cells (see CoreField.h, environmentCore.cpp), 0 keeps every cell
+    double coreDepth = 0;
+};
+
+class EnvironmentBase{
+public:
+    /*
+     * dimension-independent interface of a simulation
+     * create<Model>() reads envParams[1] once and builds an Environment<2, Model> or Environment<3, Model>
+     * parameters passed in have to be loaded for the same model
+     */
+    template<class Model>
+    static std::unique_ptr<EnvironmentBase> create(std::string saveFld, RunOptions opts = RunOptions());
+    template<class Model>
+    static std::unique_ptr<EnvironmentBase> create(std::string saveFld, std::shared_ptr<const Parameters> parameters,
+                                                   RunOptions opts = RunOptions());
+    virtual ~EnvironmentBase() = default;
+
+    virtual void initialize(double tstep) = 0;
+    // source has to be an environment of the same dimension
+    virtual void startFrom(const EnvironmentBase &source) = 0;
+    virtual void simulate(double tstep) = 0;
+
+    virtual void saveCheckpoint(std::string file) = 0;
+    virtual void loadCheckpoint(std::string file) = 0;
+    // burn-in cache entry initialize() would load or grow, without extension, empty without a cache
+    virtual std::string burnInEntry(double tstep) = 0;
+
+    // stopping criteria are checked every simulated day
+    virtual void addStoppingCriterion(std::shared_ptr<StoppingCriterion> criterion) = 0;
+
+    // state queries, counts are kept live and cost nothing
+    virtual const PopulationCounts &populationCounts() const = 0;
+    virtual int numCells(int type) const = 0;
+    virtual int numCells(int type, int state) const = 0;
+    virtual double day() const = 0;
+    virtual double getTumorRadius() const = 0;
+    virtual std::string getStopReason() const = 0;
+    // z is 0 in 2D
+    virtual std::array<double, 3> getTumorCenter() const = 0;
+
+    // one row per simulated day: day, cancer, active CD8, suppressed CD8, tumor radius
+    virtual const std::vector<std::array<double, 5>> &getDailyOutputs() const = 0;
+};
+
+template<int Dim, class Model>
+class Environment : public EnvironmentBase{
+public:
+    /*
+     * Dim = 2 or 3, cells and vectors only hold the components that exist
+     * Model is the policy of the model variant, see Models.h
+     * explicit instantiations are at the bottom of the environment*.cpp files
+     */
+    using Vec = typename Cell<Dim>::Vec;
+
+    Environment(std::string saveFld, RunOptions opts = RunOptions());
+    Environment(std::string saveFld, std::shared_ptr<const Parameters> parameters, RunOptions opts = RunOptions());
+    void initialize(double tstep) override;
+    void startFrom(const EnvironmentBase &source) override;
+    void simulate(double tstep) override;
+
+    void saveCheckpoint(std::string file) override;
+    void loadCheckpoint(std::string file) override;
+    std::string burnInEntry(double tstep) override;
+
+    void addStoppingCriterion(std::shared_ptr<StoppingCriterion> criterion) override;
+
+    const PopulationCounts &populationCounts() const override;
+    int numCells(int type) const override;
+    int numCells(int type, int state) const override;
+    double day() const override;
+    double getTumorRadius() const override;
+    std::string getStopReason() const override;
+    std::array<double, 3> getTumorCenter() const override;
+    const CellList<Dim> &cells() const;
+
+    const std::vector<std::array<double, 5>> &getDailyOutputs() const override;
+
+private:
+    void initializeTumor();
+    bool runStep(double tstep);
+    bool checkStoppingCriteria();
+    void saveTermination();
+    void runCells(double tstep);
+    void neighborInfluenceInteractions(double tstep);
+    void internalCellFunctions(double tstep);
+    void inheritNeighbors(int parent);
+    void buildNeighbors();
+    NeighborSpan neighborsOf(int i) const;
+    void buildContacts();
+    bool contactsStale();
+    NeighborSpan contactsOf(int i) const;
+    template<class Work>
+    void balanceChunks(std::vector<int> &chunks, Work work);
+    template<class Body>
+    void forChunks(const std::vector<int> &chunks, int phase, Body body);
+    void saveThreadBalance();
+    void recruitImmuneCells(double tstep);
+    double recruitmentIncrement(double tstep);
+    Vec recruitImmuneWhole(uint64_t lineage);
+    Cell<Dim> newCell(Vec loc, std::string cellType, double time, uint64_t lineage);
+    void bindCellTypes();
+    void recount();
+    void syncPopulation();
+
+    void exchangeHalo();
+    void updateHalo();
+    void dropHalo();
+    int applyGhostKills();
+    void migrateCells();
+    void rebalance();
+    void distribute();
+    void gatherCells(CellList<Dim> &all);
+    std::vector<char> packCells(const std::vector<int> &indices);
+    void unpackCells(const std::vector<char> &bytes, CellList<Dim> &into);
+
+    void placeCore(double tstep);
+    void guardCore(double tstep);
+    void stepCore(double tstep);
+    void releaseCore();
+    void releaseBin(int b);
+    void placeHeld(int b, CellList<Dim> &into, bool release);
+    void heldCells(CellList<Dim> &into);
+    void coreWall(Cell<Dim> &cell, bool overlap);
+    double coreGuard(double tstep);
+    double coreDraw(uint64_t key, crn::Event event);
+
+    // false if replace is off and file already existed, which is left as it was
+    bool writeCheckpoint(const std::string &file, bool replace);
+    void startFromBurnIn(double tstep);
+    std::string burnInKey(double tstep);
+    std::string burnInFile(const std::string &key);
+    void reseed();
+
+    void save(double tstep);
+    void saveImage();
+    void recordDay();
+
+    void calculateForces(double tstep);
+
+    void printStep(double time);
+    void printMode();
+    void tumorSize(bool findEdges = true);
+    void moveTumorCenter(const std::array<double, Dim> &cancerSum, double maxDistance);
+    double effectiveStep(double tstep);
+    void updateMode();
+
+    void updateStepProbabilities(double tstep);
+
+    double dt;
+    // per-type event probabilities at the current step size, and the per-step inhibition probability of each cancer cell
+    std::array<StepProbabilities, 2> stepProbs;
+    FirstTouchVector<double> inhibitionProbs;
+    // step size the cells' event timers were sampled at, they are resampled when it changes
+    double timerStep;
+    // fidelity scaling, see RunOptions::fidelity
+    int fidelityScale;
+    bool neighborsValid;
+
+    // cell lists, spareCells receives the kept cells when dead ones are removed and is then swapped in
+    CellList<Dim> cell_list;
+    CellList<Dim> spareCells;
+    // counts of this rank's cells, kept live, and their sum over all ranks, which queries and outputs report
+    PopulationCounts population;
+    PopulationCounts worldPopulation;
+    std::vector<Vec> edgeCells;
+
+    // neighbor lists of all cells in one buffer, rebuilt in place so steps do not allocate
+    // threadNeighbors collects each thread's contiguous block of cells before they are joined
+    FirstTouchVector<int> neighborIndices;
+    std::vector<std::vector<int>> threadNeighbors;
+    // kills of the CD8 a thread is resolving, applied once the CD8 is known to stay active
+    std::vector<std::vector<int>> threadTargets;
+
+    // contact lists, the neighbors within force or contact range plus contactSkin, with their distances when built
+    // each cell's list is stored in its slice of the neighbor buffer, contactX are the positions at the build
+    FirstTouchVector<int> contactIndices;
+    FirstTouchVector<real> contactDistances;
+    FirstTouchVector<int> contactCounts;
+    FirstTouchVector<Vec> contactX;
+    double contactSkin;
+    double contactRange[2];
+
+    // per-thread cell ranges of the loops over contacts, see balanceChunks
+    std::vector<int> contactChunks;
+    std::vector<int> sweepChunks;
+    std::vector<int> forceChunks;
+    std::vector<int> overlapChunks;
+    std::vector<long long> chunkWork;
+    // busy CPU seconds per thread in each of those loops, with RunOptions::threadTiming
+    enum Phase{contactPhase, sweepPhase, forcePhase, overlapPhase, numPhases};
+    std::vector<std::array<double, numPhases>> threadBusy;
+
+    // domain decomposition, see Domain.h
+    // during a step cell_list holds the owned cells [0, numOwned) followed by ghosts,
+    // copies of the cells of other ranks within haloWidth of this rank's slab
+    Domain domain;
+    int numOwned;
+    double haloWidth;
+    // owned cells sent to each rank as ghosts, and the rank and position in that rank's list every ghost came from
+    std::vector<std::vector<int>> haloSend;
+    std::vector<int> ghostRank;
+    std::vector<int> ghostSlot;
+    // ghosts killed by this rank's CD8 during the sweep, reported to their owners
+    std::vector<int> ghostKills;
+
+    // cancer cells held as counts with RunOptions::coreDepth, they are part of population like the cells in cell_list
+    CoreField<Dim> core;
+
+    // parameter lists
+    std::shared_ptr<const Parameters> params;
+    const std::vector<std::vector<double>> &cellParams;
+    const std::vector<double> &recParams;
+    const std::vector<double> &envParams;
+
+    std::string saveDir;
+    int steps;
+    double cd8RecRate;
+    double cd8Ratio;
+    double recDist;
+    double cd82rec;
+    double tumorRadius;
+    Vec tumorCenter;
+
+    // environment params
+    double simulationDuration;
+
+    // execution mode
+    RunOptions options;
+    bool parallel;
+    bool initialized;
+    std::vector<std::array<double, 5>> dailyOutputs;
+
+    // early termination
+    std::vector<std::shared_ptr<StoppingCriterion>> stoppingCriteria;
+    std::string stopReason;
+    double stepSize;
+
+    std::mt19937 mt;
+};
+
+template<class Model>
+std::unique_ptr<EnvironmentBase> EnvironmentBase::create(std::string saveFld, RunOptions opts) {
+    return create<Model>(saveFld, Parameters::load<Model>(saveFld+"/params"), opts);
+}
+
+template<class Model>
+std::unique_ptr<EnvironmentBase> EnvironmentBase::create(std::string saveFld, std::shared_ptr<const Parameters> parameters, RunOptions opts) {
+    // the dimension is fixed for the whole run, so it is chosen once here
+    if(parameters->envParams[1] == 1){
+        return std::unique_ptr<EnvironmentBase>(new Environment<3, Model>(saveFld, parameters, opts));
+    }
+    return std::unique_ptr<EnvironmentBase>(new Environment<2, Model>(saveFld, parameters, opts));
+}
+
+#endif //IMMUNE_MODEL_ENVIRONMENT_H
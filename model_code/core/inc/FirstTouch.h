@@ -0,0 +1,60 @@
+#ifndef IMMUNE_MODEL_FIRSTTOUCH_H
+#define IMMUNE_MODEL_FIRSTTOUCH_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <omp.h>
+
+/*
+ * FIRST-TOUCH ALLOCATION
+ * ----------------------
+ * on a multi-socket machine a page of memory is placed on the NUMA node of the thread that first writes it
+ * arrays filled by a serial loop therefore end up on one node, and every parallel loop reads them remotely
+ * this allocator writes one byte per page of a fresh block from an OpenMP team with a static split,
+ * so thread t's share of the block lands on thread t's node before the serial code constructs the elements
+ * cells and per-cell arrays are processed in contiguous ranges per thread, which then mostly stay on-node
+ *
+ * only blocks of at least firstTouchBytes allocated outside a parallel region are touched this way
+ * blocks taken from memory the process already used keep their old placement
+ * threads have to be pinned (OMP_PROC_BIND, OMP_PLACES) for the placement to help, see README
+ */
+
+constexpr std::size_t firstTouchPage = 4096;
+constexpr std::size_t firstTouchBytes = 64*firstTouchPage;
+
+template<class T>
+struct FirstTouchAllocator{
+    using value_type = T;
+
+    FirstTouchAllocator() = default;
+    template<class U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>&) {}
+
+    T *allocate(std::size_t n) {
+        std::size_t bytes = n*sizeof(T);
+        char *block = static_cast<char*>(::operator new(bytes));
+        if(bytes >= firstTouchBytes && !omp_in_parallel() && omp_get_max_threads() > 1){
+            long pages = static_cast<long>((bytes-1)/firstTouchPage) + 1;
+#pragma omp parallel for schedule(static)
+            for(long k=0; k<pages; ++k){
+                block[k*firstTouchPage] = 0;
+            }
+        }
+        return reinterpret_cast<T*>(block);
+    }
+    void deallocate(T *p, std::size_t) {
+        ::operator delete(p);
+    }
+};
+
+template<class T, class U>
+bool operator==(const FirstTouchAllocator<T>&, const FirstTouchAllocator<U>&) {return true;}
+template<class T, class U>
+bool operator!=(const FirstTouchAllocator<T>&, const FirstTouchAllocator<U>&) {return false;}
+
+// per-cell arrays of the environment
+template<class T>
+using FirstTouchVector = std::vector<T, FirstTouchAllocator<T>>;
+
+#endif //IMMUNE_MODEL_FIRSTTOUCH_H
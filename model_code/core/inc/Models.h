@@ -0,0 +1,123 @@
+#ifndef IMMUNE_MODEL_MODELS_H
+#define IMMUNE_MODEL_MODELS_H
+
+#include <fstream>
+#include "Cell.h"
+
+/*
+ * MODEL VARIANTS
+ * --------------
+ * the simulation core, Environment<Dim, Model>, is shared by the example models
+ * what differs between them is supplied by a policy struct at compile time,
+ * so every model gets its own specialized engine with the behaviors inlined into the cell loops
+ *
+ * a policy provides
+ *  name - part of the burn-in cache key
+ *  cellTypes(cellParams) - per-type parameter blocks, each model has its own cellParams layout
+ *  initialRings(envParams), initialCD8Fraction - initial tumor, CD8 placed around it relative to the cancer cells
+ *  influence, addInfluence, influenceResponse - influences collected from neighbors and the cancer cells' response
+ *  inhibition, inhibitionProbability, inhibit - CD8 inhibition by a cancer cell in contact,
+ *   with the per-step probability computed once per cancer cell
+ *  cancerDeath - model specific cancer death on top of aging and CD8 killing, given the type's step probabilities
+ *  coreDeath - the same for the living cells held at position x in the hybrid core (CoreField.h), as a probability
+ *  removeDeadCells - dead cells are removed, otherwise they stay as a necrotic mass
+ *  saveCells(saveDir, cells) - the cell csv files read by the model's python code
+ * the flags let the environment skip whole loops a model does not use
+ */
+
+template<class T, size_t N>
+inline double zOf(const std::array<T, N> &x) {
+    // the csv outputs keep a z column in 2D
+    return N == 3 ? x[N-1] : 0.0;
+}
+
+struct PDL1Model{
+    /*
+     * example_1: CD8 influence induces PD-L1 on cancer cells, contact with PD-L1 suppresses CD8
+     */
+    static constexpr const char *name = "pdl1";
+    static constexpr bool influence = true;
+    static constexpr bool inhibition = true;
+    static constexpr bool removeDeadCells = true;
+    static constexpr double initialCD8Fraction = 0;
+
+    static std::array<CellTypeParams, 2> cellTypes(const std::vector<std::vector<double>> &cellParams);
+    static int initialRings(const std::vector<double> &/*envParams*/){return 5;}
+
+    template<int Dim>
+    static void addInfluence(Cell<Dim> &cell, const Cell<Dim> &other){
+        cell.addInfluence(other.x, other.influenceRadius(), other.state);
+    }
+
+    template<int Dim>
+    static void influenceResponse(Cell<Dim> &cancer, double tstep){
+        cancer.gainPDL1(tstep);
+    }
+
+    template<int Dim>
+    static double inhibitionProbability(const Cell<Dim> &cancer, double tstep){
+        return Cell<Dim>::probTime(cancer.pdl1, tstep);
+    }
+
+    template<int Dim>
+    static void inhibit(Cell<Dim> &cd8, const Cell<Dim> &cancer, double pInhibit){
+        cd8.pdl1Inhibition(pInhibit, cancer.lineage);
+    }
+
+    template<int Dim>
+    static void cancerDeath(Cell<Dim> &/*cancer*/, const typename Cell<Dim>::Vec &/*tumorCenter*/, const StepProbabilities &/*step*/){}
+
+    template<int Dim>
+    static double coreDeath(const typename Cell<Dim>::Vec &/*x*/, const typename Cell<Dim>::Vec &/*tumorCenter*/,
+                            const CellTypeParams &/*cancer*/, const StepProbabilities &/*step*/){return 0;}
+
+    template<int Dim>
+    static void saveCells(const std::string &saveDir, const CellList<Dim> &cells);
+};
+
+struct HypoxiaModel{
+    /*
+     * example_2: no influences or suppression, cancer cells in the hypoxic core die and stay in place
+     * CD8 are placed around the initial tumor rather than recruited (recParams[0] = 0)
+     */
+    static constexpr const char *name = "hypoxia";
+    static constexpr bool influence = false;
+    static constexpr bool inhibition = false;
+    static constexpr bool removeDeadCells = false;
+    static constexpr double initialCD8Fraction = 0.2;
+
+    static std::array<CellTypeParams, 2> cellTypes(const std::vector<std::vector<double>> &cellParams);
+    static int initialRings(const std::vector<double> &envParams){return static_cast<int>(envParams[2]);}
+
+    template<int Dim>
+    static void addInfluence(Cell<Dim> &/*cell*/, const Cell<Dim> &/*other*/){}
+
+    template<int Dim>
+    static void influenceResponse(Cell<Dim> &/*cancer*/, double /*tstep*/){}
+
+    template<int Dim>
+    static double inhibitionProbability(const Cell<Dim> &/*cancer*/, double /*tstep*/){return 0;}
+
+    template<int Dim>
+    static void inhibit(Cell<Dim> &/*cd8*/, const Cell<Dim> &/*cancer*/, double /*pInhibit*/){}
+
+    template<int Dim>
+    static void cancerDeath(Cell<Dim> &cancer, const typename Cell<Dim>::Vec &tumorCenter, const StepProbabilities &step){
+        cancer.dieFromHypoxia(tumorCenter, step.hypoxia);
+    }
+
+    template<int Dim>
+    static double coreDeath(const typename Cell<Dim>::Vec &x, const typename Cell<Dim>::Vec &tumorCenter,
+                            const CellTypeParams &cancer, const StepProbabilities &step){
+        double distance2 = 0;
+        for(int d=0; d<Dim; ++d){
+            distance2 += (x[d] - tumorCenter[d])*(x[d] - tumorCenter[d]);
+        }
+        return distance2 < cancer.hypoxicL*cancer.hypoxicL ? step.hypoxia : 0.0;
+    }
+
+    template<int Dim>
+    static void saveCells(const std::string &saveDir, const CellList<Dim> &cells);
+};
+
+#endif //IMMUNE_MODEL_MODELS_H
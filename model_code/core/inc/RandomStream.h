@@ -0,0 +1,75 @@
+#ifndef IMMUNE_MODEL_RANDOMSTREAM_H
+#define IMMUNE_MODEL_RANDOMSTREAM_H
+
+#include <cstdint>
+
+/*
+ * COMMON RANDOM NUMBERS
+ * ---------------------
+ * counter-based random numbers: every draw is a hash of (run seed, cell lineage, event, step, draw)
+ * a draw does not depend on how many numbers were used before it, so two runs with the same seed
+ * at nearby parameters make the same decision for the same cell at the same time
+ * wherever their histories have not diverged
+ *
+ * hash is the splitmix64 finalizer applied once per key
+ */
+
+namespace crn{
+    enum Event : uint64_t{
+        stream = 0,         // seed of the cell's own generator (forces, migration, infiltration)
+        proliferation = 1,
+        divisionAngle = 2,
+        death = 3,
+        kill = 4,
+        inhibition = 5,
+        pdl1Gain = 6,
+        recruitment = 7,    // lineage of a recruited cell
+        recruitLocation = 8,
+        daughter = 9,       // lineage of a daughter cell
+        hypoxia = 10,
+        initialPlacement = 11,
+        core = 12           // bins of the hybrid core, and the lineage of a cell released from one
+    };
+
+    inline uint64_t mix(uint64_t z){
+        z += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    inline uint64_t key(uint64_t seed, uint64_t lineage, uint64_t event, uint64_t step, uint64_t draw = 0){
+        uint64_t h = mix(seed);
+        h = mix(h ^ lineage);
+        h = mix(h ^ (event << 56) ^ step);
+        return mix(h ^ draw);
+    }
+
+    // uniform on [0, 1) from the top 53 bits
+    inline double uniform(uint64_t h){
+        return static_cast<double>(h >> 11)*0x1.0p-53;
+    }
+}
+
+class SplitMix64{
+    /*
+     * small sequential generator for each cell's own draws (8 bytes of state)
+     * usable with the std distributions
+     */
+public:
+    using result_type = uint64_t;
+    explicit SplitMix64(uint64_t seed = 0): state(seed) {}
+    void seed(uint64_t s){state = s;}
+    static constexpr result_type min(){return 0;}
+    static constexpr result_type max(){return UINT64_MAX;}
+    result_type operator()(){
+        uint64_t z = state;
+        state += 0x9e3779b97f4a7c15ULL;
+        return crn::mix(z);
+    }
+
+private:
+    uint64_t state;
+};
+
+#endif //IMMUNE_MODEL_RANDOMSTREAM_H
@@ -0,0 +1,50 @@
+#ifndef IMMUNE_MODEL_REPLICATES_H
+#define IMMUNE_MODEL_REPLICATES_H
+
+#include <functional>
+#include "Environment.h"
+
+/*
+ * replicate mode
+ * --------------
+ * runs R independent stochastic trajectories of one parameter set of a model (Models.h) in a single process
+ * the parameters are loaded once and shared read-only between the replicates
+ * with a burn-in cache replicate r starts from sample r % burnInSamples
+ * otherwise the seed tumor is placed once and copied into every replicate with fresh random streams
+ * replicates are scheduled dynamically over the OpenMP threads, each running serially
+ *
+ * writes saveFld/replicateStats.csv with one row per day:
+ *  day, n, extinct, pruned, then mean and sample variance of cancer, active CD8, suppressed CD8, tumor radius
+ * every replicate counts on every day (n = R), one that stopped early is carried forward in its final state
+ * extinct and pruned count the replicates carried forward because their tumor died out or a stopping criterion ended them
+ */
+
+struct DailyStats{
+    double day;
+    int n;
+    int extinct;
+    int pruned;
+    // cancer, active CD8, suppressed CD8, tumor radius
+    std::array<double, 4> mean;
+    std::array<double, 4> var;
+};
+
+template<class Model>
+std::vector<DailyStats> runReplicates(std::string saveFld, RunOptions opts, int replicates, double tstep, int burnInSamples = 1,
+                                      const std::function<void(EnvironmentBase&)> &configure = nullptr);
+
+/*
+ * fidelity calibration
+ * --------------------
+ * runs the replicates at every fidelity level from 0 to maxLevel (in saveFld/fidelity_<L>)
+ * and writes saveFld/fidelityCalibration.csv with one row per level:
+ *  level, wall time, speed-up over level 0, then for each statistic
+ *  the mean relative error of the daily mean against level 0
+ *  and the mean |difference|/standard error, where values near 1 or below are within replicate noise
+ */
+
+template<class Model>
+void calibrateFidelity(std::string saveFld, RunOptions opts, int maxLevel, int replicates, double tstep, int burnInSamples = 1,
+                       const std::function<void(EnvironmentBase&)> &configure = nullptr);
+
+#endif //IMMUNE_MODEL_REPLICATES_H
@@ -0,0 +1,44 @@
+#ifndef IMMUNE_MODEL_STOPPINGCRITERIA_H
+#define IMMUNE_MODEL_STOPPINGCRITERIA_H
+
+#include <string>
+#include "Environment.h"
+
+/*
+ * stopping criteria for parameter estimation runs
+ * -----------------------------------------------
+ * each criterion is checked once per simulated day
+ * check() returns an empty string to continue, otherwise the reason the run was stopped
+ * the reason is written to termination.csv
+ */
+
+class StoppingCriterion{
+public:
+    virtual ~StoppingCriterion() = default;
+    virtual std::string check(const EnvironmentBase &env) = 0;
+};
+
+class CellCountBounds : public StoppingCriterion{
+public:
+    // stop on runaway growth (more than maxCancer) or near clearance (fewer than minCancer)
+    // a bound of -1 is not checked
+    CellCountBounds(int minCancer, int maxCancer, int maxCD8);
+    std::string check(const EnvironmentBase &env) override;
+
+private:
+    int minCancer;
+    int maxCancer;
+    int maxCD8;
+};
+
+class TumorRadiusBound : public StoppingCriterion{
+public:
+    // stop once the tumor radius (um) is larger than maxRadius
+    explicit TumorRadiusBound(double maxRadius);
+    std::string check(const EnvironmentBase &env) override;
+
+private:
+    double maxRadius;
+};
+
+#endif //IMMUNE_MODEL_STOPPINGCRITERIA_H
@@ -0,0 +1,37 @@
+#include "Cell.h"
+
+template<int Dim>
+void Cell<Dim>::initializeCD8Cell() {
+    state = 1;
+
+    std::normal_distribution<double> infilDist(0.0, typeParams->infiltrationSD);
+    //std::uniform_real_distribution<double> infilDist(0.0, cellParams[8][1]);
+    infiltrationDistance = fabs(infilDist(rng));
+}
+
+template<int Dim>
+void Cell<Dim>::pdl1Inhibition(double pInhibit, uint64_t otherLineage) {
+    // inhibition via direct contact, checked by the caller
+    // pInhibit is the per-step probability from the other cell's PD-L1, computed once per cancer cell
+
+    if(type != 1){return;}
+    if(state == 2){return;}
+
+    if(draw(crn::inhibition, otherLineage) < pInhibit){
+        // suppression removes killing and migration and reduces the influence radius, see Cell.h
+        state = 2;
+    }
+}
+
+template<int Dim>
+bool Cell<Dim>::kills(double pKill, uint64_t otherLineage) {
+    /*
+     * kill attempt on a cancer cell in contact, the environment marks the target
+     * each CD8 gets its own draw, with common random numbers it is keyed by the pair (target's lineage, this cell's),
+     * which keeps the draws identical to the code before kills moved into the CD8 sweep
+     */
+    return pairDraw(crn::kill, otherLineage, lineage) < pKill;
+}
+
+template class Cell<2>;
+template class Cell<3>;
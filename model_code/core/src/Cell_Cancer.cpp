@@ -0,0 +1,46 @@
+#include "Cell.h"
+
+template<int Dim>
+void Cell<Dim>::initializeCancerCell() {
+    state = 0;
+    canProlif = true;
+}
+
+template<int Dim>
+void Cell<Dim>::dieFromHypoxia(const Vec &tumorCenter, double pHypoxia) {
+    /*
+     * hypoxicL is the radius of the hypoxic core around the tumor center
+     * living cells inside it die with probability hypoxicP per hour (pHypoxia per step)
+     */
+    if(state != 0){return;}
+
+    if(calcDistance(tumorCenter) < typeParams->hypoxicL && draw(crn::hypoxia) < pHypoxia){
+        state = -1;
+    }
+}
+
+template<int Dim>
+void Cell<Dim>::inherit(double pd) {
+    /*
+     * daughter cells have the same EMT and PD-L1 as the mother cell
+     */
+    if(type != 0){return;}
+
+    pdl1 = pd;
+}
+
+template<int Dim>
+void Cell<Dim>::gainPDL1(double dt) {
+    if(type != 0){return;}
+
+    // induced by ifn-y secreting cells
+    // posInfluence is Th + active CD8
+    double posInfluence = influences[1];
+    if(draw(crn::pdl1Gain) < probTime(posInfluence, dt)){
+        pdl1 += typeParams->pdl1Shift;
+    }
+    pdl1 = std::min(pdl1,typeParams->pdl1WhenExpressed);
+}
+
+template class Cell<2>;
+template class Cell<3>;
@@ -0,0 +1,508 @@
+#include "Cell.h"
+#include "Checkpoint.h"
+
+/*
+ * BIOLOGICAL AND MODELING INFO
+ * ----------------------------
+ * - cell forces taken from Osborne 2017
+ */
+
+/*
+ * CELL TYPES
+ * 0 - cancer
+ * 1 - CD8
+ *
+ * CELL STATES
+ * -1 - dead
+ * 0 - alive (cancer)
+ * 1 - active (CD8)
+ * 2 - suppressed (CD8)
+ *
+ */
+
+// ********************
+// INITIALIZE CELL TYPE
+template<int Dim>
+Cell<Dim>::Cell(Vec loc, int idx, const CellTypeParams *params, double time, uint64_t seed):
+        typeParams(params), rng(seed) {
+    type = params->type;
+    x = loc;
+    id = idx;
+    timeBorn = time;
+    lineage = 0;
+    currentStep = 0;
+    commonRandom = false;
+    crnSeed = 0;
+    eventTimers = false;
+    resetEventTimers();
+
+    /*
+     * initialize per-cell state as 0
+     * then initialize only the relevant state
+     */
+    compressed = false;
+    currentOverlap = 0;
+    neighborStart = 0;
+    neighborCount = 0;
+    canProlif = false;
+    currentForces.fill(0);
+    infiltrationDistance = 0;
+    pdl1 = 0;
+    for(int i=0; i<influences.size(); ++i){
+        influences[i] = 0;
+    }
+    state = 0;
+
+    if(type == 0){
+        initializeCancerCell();
+    } else if(type == 1){
+        initializeCD8Cell();
+    } else{
+        std::cout << "Cell type requested: " << type << std::endl;
+        throw std::runtime_error("Cell::Cell -> unavailable cell type");
+    }
+}
+// ********************
+
+// ************************
+// BIO-MECHANICAL FUNCTIONS
+// ---------------
+// FORCE FUNCTIONS
+template<int Dim>
+typename Cell<Dim>::Vec Cell<Dim>::attractiveForce(const Vec &dx, double otherRadius) {
+    double dxNorm = calcNorm(dx);
+    double sij = typeParams->radius + otherRadius;
+
+    double scaleFactor = typeParams->mu*(dxNorm - sij)*exp(-typeParams->kc*(dxNorm - sij)/sij);
+    Vec force;
+    for(int d=0; d<Dim; ++d){
+        force[d] = (dx[d]/dxNorm)*scaleFactor;
+    }
+    return force;
+}
+
+template<int Dim>
+typename Cell<Dim>::Vec Cell<Dim>::repulsiveForce(const Vec &dx, double otherRadius) {
+    double dxNorm = calcNorm(dx);
+    double sij = typeParams->radius + otherRadius;
+
+    double scaleFactor = typeParams->mu*sij*log10(1 + (dxNorm - sij)/sij);
+    Vec force;
+    for(int d=0; d<Dim; ++d){
+        force[d] = (dx[d]/dxNorm)*scaleFactor;
+    }
+    return force;
+}
+
+template<int Dim>
+void Cell<Dim>::calculateForces(const Vec &otherX, double otherRadius, int &otherType) {
+    real distance = calcDistance(otherX);
+    if(distance < typeParams->rmax){
+        Vec dx;
+        for(int d=0; d<Dim; ++d){
+            dx[d] = otherX[d]-x[d];
+        }
+        if(distance < (typeParams->radius + otherRadius)){
+            Vec force = repulsiveForce(dx, otherRadius);
+            for(int d=0; d<Dim; ++d){
+                currentForces[d] += force[d];
+            }
+        } else if(type == 0 && otherType == 0){ // attraction if both are cancer cells
+            Vec force = attractiveForce(dx, otherRadius);
+            for(int d=0; d<Dim; ++d){
+                currentForces[d] += force[d];
+            }
+        }
+    }
+}
+
+template<int Dim>
+void Cell<Dim>::resolveForces(double dt) {
+    double damping = typeParams->damping;
+    for(int d=0; d<Dim; ++d){
+        x[d] += (dt/damping)*currentForces[d];
+    }
+
+    resetForces();
+}
+
+template<int Dim>
+void Cell<Dim>::resetForces() {
+    /*
+     * resets forces with a slight randomizing factor
+     */
+    double D = 1;
+    std::uniform_real_distribution<double> dis(-D, D);
+    for(int d=0; d<Dim; ++d){
+        currentForces[d] = dis(rng);
+    }
+}
+
+template<int Dim>
+bool Cell<Dim>::inContact(const Vec &otherX, double otherRadius){
+    return calcDistance(otherX) <= typeParams->radius+otherRadius;
+}
+
+template<int Dim>
+bool Cell<Dim>::isNeighbor(const Vec &otherX){
+    /*
+     * determine which cells are within 2*maximum interaction distance
+     */
+    return calcDistance(otherX) <= 10*typeParams->rmax;
+}
+
+// OVERLAP FUNCTIONS
+template<int Dim>
+void Cell<Dim>::calculateOverlap(const Vec &otherX, double otherRadius) {
+    double distance = calcDistance(otherX);
+    if(distance < typeParams->radius + otherRadius){
+        currentOverlap += typeParams->radius + otherRadius - distance;
+    }
+}
+
+template<int Dim>
+void Cell<Dim>::resetOverlap() {
+    currentOverlap = 0;
+}
+
+template<int Dim>
+void Cell<Dim>::isCompressed() {
+    compressed = currentOverlap > typeParams->maxOverlap;
+    resetOverlap();
+}
+// ************************
+
+// *****************************
+// SPECIFIC BIOLOGICAL FUNCTIONS
+// -----------------------
+// CELL BEHAVIOR FUNCTIONS
+template<int Dim>
+std::array<double, Dim+1> Cell<Dim>::proliferate(double pDivision) {
+    // positions 0 to Dim-1 are cell location
+    // position Dim is boolean didProliferate?
+    std::array<double, Dim+1> daughter{};
+    if(!canProlif){return daughter;}
+
+    bool divides = eventTimers ? eventDue(divisionCountdown, crn::proliferation, pDivision)
+                               : draw(crn::proliferation) < pDivision;
+    if(divides){
+        // place daughter cell a random angle away from the mother cell
+        Vec dx;
+        for(int d=0; d<Dim; ++d){
+            dx[d] = 2*draw(crn::divisionAngle, d) - 1;
+        }
+        double norm = calcNorm(dx);
+        for(int d=0; d<Dim; ++d){
+            daughter[d] = typeParams->radius*(dx[d]/norm)+x[d];
+        }
+        daughter[Dim] = 1;
+    }
+    return daughter;
+}
+
+template<int Dim>
+void Cell<Dim>::age(double pDeath) {
+    /*
+     * cells die based on a probability equal to 1/lifespan
+     * pDeath is the per-step probability, see StepProbabilities
+     */
+    bool dies = eventTimers ? eventDue(deathCountdown, crn::death, pDeath) : draw(crn::death) < pDeath;
+    if(dies){
+        state = -1;
+    }
+}
+
+template<int Dim>
+void Cell<Dim>::migrate(double dt, const std::vector<Vec> &edgeCells, const Vec &tumorCenter) {
+    /*
+     * biased random-walk towards their target
+     *
+     * bias is done by generating a random vector, then adding it to the correct direction with scaling
+     */
+    std::uniform_real_distribution<double> dis(-1,1);
+
+    // immune cells migrate towards the tumor, cancer cells do not move (speed 0)
+    Vec target = tumorCenter;
+    if(type == 0){
+        target.fill(0);
+        target[0] = 1e6;
+        target[1] = 1e6;
+    }
+    Vec dx;
+    for(int d=0; d<Dim; ++d){
+        dx[d] = target[d] - x[d];
+    }
+    // the random direction is drawn and normalized in 3D, 2D keeps its in-plane part, which is shorter than 1
+    std::array<double, 3> randomVector = {dis(rng), dis(rng), dis(rng)};
+
+    double norm = calcNorm(dx);
+    double normRV = std::sqrt(randomVector[0]*randomVector[0] + randomVector[1]*randomVector[1]
+                              + randomVector[2]*randomVector[2]);
+    double migrationBias = typeParams->migrationBias;
+    for(int i=0; i<dx.size(); ++i){
+        dx[i] /= norm;
+        randomVector[i] /= normRV;
+        dx[i] = migrationBias*dx[i] + (1 - migrationBias)*randomVector[i];
+    }
+    norm = calcNorm(dx);
+
+    // determine distance from tumor edge
+    /*
+     * first, find nearest edge cell
+     */
+    int idx = 0;
+    double distFromEdge = 1e6;
+    for(int i=0; i<edgeCells.size(); ++i){
+        double dist = calcDistance(edgeCells[i]);
+        if(dist < distFromEdge){
+            distFromEdge = dist;
+            idx = i;
+        }
+    }
+    Vec edgeDx;
+    for(int d=0; d<Dim; ++d){
+        edgeDx[d] = edgeCells[idx][d] - tumorCenter[d];
+    }
+    double edgeDistFromCenter = calcNorm(edgeDx);
+
+    // if migrating into the tumor, stop if the infiltration distance is reached
+    double distanceFromCenter = calcDistance(tumorCenter);
+    for(int i=0; i<x.size(); ++i){
+        x[i] += dt*migrationSpeed()*(dx[i]/norm)*(edgeDistFromCenter - distanceFromCenter < infiltrationDistance*edgeDistFromCenter);
+    }
+    if(fabs(x[0]) > 1e10 || fabs(x[1]) > 1e10){
+        std::cout << "Error\n";
+        std::cout << "Type: " << type << std::endl;
+        std::cout << "X: " << x[0] << std::endl;
+        std::cout << "Mig Speed: " << migrationSpeed() << std::endl;
+        std::cout << "dx/norm: " << dx[0]/norm << std::endl;
+        std::cout << "dist from center: " << distanceFromCenter << std::endl;
+        throw std::runtime_error("migration");
+    }
+}
+
+template<int Dim>
+void Cell<Dim>::prolifState() {
+    /*
+     * cancer cells and CD8 can proliferate
+     * right now, CD8 proliferation prob is set to 0, however leaving it in for future changes
+     */
+    if(type == 0){
+        canProlif = !(state == -1 || compressed);
+    }
+}
+
+// CELL INFLUENCE
+template<int Dim>
+void Cell<Dim>::addInfluence(const Vec &otherX, double otherInfluence, int otherState) {
+    /*
+     * determine influence based on distance for each cell state
+     *
+     * I believe I'm handling the probabilities correctly
+     * totalProb = 1 - (1-p1)*(1-p2)*...*(1-pn)
+     * the commented out way of just summing the probabilities is probably incorrect
+     */
+    if(otherState == -1){return;}
+
+    //influences[otherState] *= calcInfDistance(calcDistance(otherX), otherInfluence);
+    influences[otherState] = 1 - (1 - influences[otherState])*(1 - calcInfDistance(calcDistance(otherX), otherInfluence));
+}
+
+template<int Dim>
+void Cell<Dim>::clearInfluence() {
+    for(int i=0; i<influences.size(); ++i){
+        influences[i] = 0;
+    }
+}
+// *****************************
+
+// ***************
+// OTHER FUNCTIONS
+// ----------------------
+// MATHEMATICAL FUNCTIONS
+template<int Dim>
+double Cell<Dim>::calcDistance(const Vec &otherX) {
+    // in the precision of the positions, so the neighbor loops stay in float with SINGLE_PRECISION
+    real sum = 0;
+    for(int d=0; d<Dim; ++d){
+        real dd = otherX[d] - x[d];
+        sum += dd*dd;
+    }
+    return std::sqrt(sum);
+}
+
+template<int Dim>
+double Cell<Dim>::calcInfDistance(double dist, double xth) {
+    /*
+     * calculate influence using an exponential decay based on distance from cell center
+     */
+    double alpha = -log2(typeParams->probTh);
+    double lambda = alpha*0.693/xth;
+
+    return exp(-lambda*dist);
+}
+
+template<int Dim>
+double Cell<Dim>::calcNorm(const Vec &dx){
+    real sum = 0;
+    for(int d=0; d<Dim; ++d){
+        sum += dx[d]*dx[d];
+    }
+    return std::sqrt(sum);
+}
+
+template<int Dim>
+double Cell<Dim>::probTime(double pInit, double tstep) {
+    /*
+     * assumes an initial probability at a 1 hr timestep
+     *
+     * p0 = initial probability
+     * dt0 = initial timestep
+     * dtn = new timestep
+     * steps = dtn/dt0
+     * p = 1 - (1 - p0)^steps
+     *
+     * constant inputs are cached per type (StepProbabilities), what is left are PD-L1 and influence values,
+     * which are mostly zero, so those skip the pow
+     */
+    if(pInit <= 0){return 0;}
+    return 1 - pow((1 - pInit), tstep);
+}
+
+// BOOK-KEEPING
+template<int Dim>
+void Cell<Dim>::updateID(int idx) {
+    id = idx;
+}
+
+template<int Dim>
+void Cell<Dim>::writeState(std::ostream &out) const {
+    /*
+     * binary dump of the per-cell state, including the generator state
+     * type parameters are rebound by the environment on load
+     * neighbor lists are stored by the environment (Environment::saveCheckpoint)
+     */
+    writeBinary(out, x);
+    writeBinary(out, compressed);
+    writeBinary(out, currentOverlap);
+    writeBinary(out, canProlif);
+    writeBinary(out, currentForces);
+    writeBinary(out, infiltrationDistance);
+    writeBinary(out, pdl1);
+    writeBinary(out, influences);
+    writeBinary(out, id);
+    writeBinary(out, type);
+    writeBinary(out, state);
+    writeBinary(out, timeBorn);
+    writeBinary(out, lineage);
+    writeBinary(out, currentStep);
+    writeBinary(out, deathCountdown);
+    writeBinary(out, divisionCountdown);
+    writeBinary(out, rng);
+    writeBinary(out, commonRandom);
+    writeBinary(out, crnSeed);
+}
+
+template<int Dim>
+void Cell<Dim>::readState(std::istream &in) {
+    // same field order as writeState
+    readBinary(in, x);
+    readBinary(in, compressed);
+    readBinary(in, currentOverlap);
+    readBinary(in, canProlif);
+    readBinary(in, currentForces);
+    readBinary(in, infiltrationDistance);
+    readBinary(in, pdl1);
+    readBinary(in, influences);
+    readBinary(in, id);
+    readBinary(in, type);
+    readBinary(in, state);
+    readBinary(in, timeBorn);
+    readBinary(in, lineage);
+    readBinary(in, currentStep);
+    readBinary(in, deathCountdown);
+    readBinary(in, divisionCountdown);
+    readBinary(in, rng);
+    readBinary(in, commonRandom);
+    readBinary(in, crnSeed);
+    typeParams = nullptr;
+    neighborStart = 0;
+    neighborCount = 0;
+}
+
+template<int Dim>
+void Cell<Dim>::reseed(uint64_t seed) {
+    rng.seed(seed);
+}
+
+template<int Dim>
+void Cell<Dim>::useCommonRandomNumbers(uint64_t seed) {
+    /*
+     * event draws become hashes of (seed, lineage, event, step) instead of the cell's generator
+     */
+    commonRandom = true;
+    crnSeed = seed;
+}
+
+template<int Dim>
+void Cell<Dim>::useEventTimers(bool on) {
+    // death and division from sampled waiting times instead of one draw per step, see eventDue
+    eventTimers = on;
+}
+
+template<int Dim>
+void Cell<Dim>::resetEventTimers() {
+    // timers are resampled at the next opportunity, needed when the step probabilities change
+    deathCountdown = -1;
+    divisionCountdown = -1;
+}
+
+template<int Dim>
+bool Cell<Dim>::eventDue(int &countdown, crn::Event event, double p) {
+    /*
+     * geometric waiting time for an event with probability p per opportunity
+     * ----------------------------------------------------------------------
+     * instead of one draw per opportunity, the number of failed opportunities before the event,
+     *  floor(log(u)/log(1 - p)) for u uniform on (0, 1],
+     * is drawn once and counted down
+     * the event then happens at the same rate as with a draw per opportunity, so results agree statistically
+     * but not draw for draw
+     * opportunities rather than steps are counted, so conditions like canProlif do not change the rate
+     */
+    if(countdown < 0){
+        if(p >= 1){
+            countdown = 0;
+        } else if(p <= 0){
+            countdown = std::numeric_limits<int>::max();
+        } else{
+            double wait = std::floor(std::log(1 - draw(event))/std::log1p(-p));
+            countdown = wait < std::numeric_limits<int>::max() ? static_cast<int>(wait) : std::numeric_limits<int>::max();
+        }
+    }
+    if(countdown == 0){
+        countdown = -1;
+        return true;
+    }
+    --countdown;
+    return false;
+}
+
+template<int Dim>
+double Cell<Dim>::draw(crn::Event event, uint64_t n) {
+    // uniform on [0, 1) for a stochastic event
+    return pairDraw(event, lineage, n);
+}
+
+template<int Dim>
+double Cell<Dim>::pairDraw(crn::Event event, uint64_t keyLineage, uint64_t n) {
+    // as draw, but common random numbers are keyed by another cell's lineage, for events drawn on its behalf
+    if(commonRandom){
+        return crn::uniform(crn::key(crnSeed, keyLineage, event, currentStep, n));
+    }
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    return dis(rng);
+}
+// ***************
+
+template class Cell<2>;
+template class Cell<3>;
@@ -0,0 +1,264 @@
+#include "CoreField.h"
+#include "Checkpoint.h"
+#include <algorithm>
+
+template<int Dim>
+CoreField<Dim>::CoreField() {
+    binSize = 1;
+    clear();
+}
+
+template<int Dim>
+void CoreField<Dim>::clear() {
+    bins.clear();
+    numHeld = 0;
+    first.fill(0);
+    extent.fill(0);
+}
+
+template<int Dim>
+void CoreField<Dim>::cover(const Vec &center, double reach, double width) {
+    /*
+     * the block of bins around the ball, widened to every held bin, which are copied over
+     * bins that are not held carry nothing between calls, so the rest starts empty
+     */
+    Index lo, hi;
+    for(int d=0; d<Dim; ++d){
+        lo[d] = static_cast<int>(std::floor((center[d] - reach)/width));
+        hi[d] = static_cast<int>(std::floor((center[d] + reach)/width));
+    }
+    std::vector<std::pair<Index, CoreBin>> kept;
+    if(width == binSize){
+        for(int b=0; b<size(); ++b){
+            if(!bins[b].held){continue;}
+            Index idx = index(b);
+            for(int d=0; d<Dim; ++d){
+                lo[d] = std::min(lo[d], idx[d]);
+                hi[d] = std::max(hi[d], idx[d]);
+            }
+            kept.push_back({idx, bins[b]});
+        }
+    } else if(numHeld > 0){
+        throw std::runtime_error("CoreField::cover -> bin size changed while bins are held");
+    }
+
+    binSize = width;
+    first = lo;
+    size_t total = 1;
+    for(int d=0; d<Dim; ++d){
+        extent[d] = hi[d] - lo[d] + 1;
+        total *= extent[d];
+    }
+    bins.assign(total, CoreBin{});
+    for(auto &k : kept){
+        int b = 0;
+        for(int d=Dim-1; d>=0; --d){
+            b = b*extent[d] + k.first[d] - first[d];
+        }
+        bins[b] = k.second;
+    }
+}
+
+template<int Dim>
+int CoreField<Dim>::find(const Vec &x) const {
+    int b = 0;
+    for(int d=Dim-1; d>=0; --d){
+        int i = static_cast<int>(std::floor(x[d]/binSize)) - first[d];
+        if(i < 0 || i >= extent[d]){return -1;}
+        b = b*extent[d] + i;
+    }
+    return b;
+}
+
+template<int Dim>
+int CoreField<Dim>::heldAt(const Vec &x) const {
+    if(numHeld == 0){return -1;}
+    int b = find(x);
+    return b >= 0 && bins[b].held ? b : -1;
+}
+
+template<int Dim>
+typename CoreField<Dim>::Index CoreField<Dim>::index(int b) const {
+    Index idx;
+    for(int d=0; d<Dim; ++d){
+        idx[d] = first[d] + b % extent[d];
+        b /= extent[d];
+    }
+    return idx;
+}
+
+template<int Dim>
+typename CoreField<Dim>::Vec CoreField<Dim>::binCenter(int b) const {
+    Index idx = index(b);
+    Vec c;
+    for(int d=0; d<Dim; ++d){
+        c[d] = (idx[d] + 0.5)*binSize;
+    }
+    return c;
+}
+
+template<int Dim>
+double CoreField<Dim>::boxDistance(int b, const Vec &x, Vec &nearest) const {
+    Index idx = index(b);
+    double sum = 0;
+    for(int d=0; d<Dim; ++d){
+        double lo = idx[d]*binSize;
+        nearest[d] = std::min(std::max(static_cast<double>(x[d]), lo), lo + binSize);
+        sum += (x[d] - nearest[d])*(x[d] - nearest[d]);
+    }
+    return std::sqrt(sum);
+}
+
+template<int Dim>
+int CoreField<Dim>::nearestHeld(const Vec &x, Vec &nearest, double &distance) const {
+    // bins are at least rmax wide, so only the bins next to x's can be within force range
+    if(numHeld == 0){return -1;}
+    Index idx;
+    for(int d=0; d<Dim; ++d){
+        idx[d] = static_cast<int>(std::floor(x[d]/binSize)) - first[d];
+    }
+    int best = -1;
+    Vec point;
+    int count = 1;
+    for(int d=0; d<Dim; ++d){
+        count *= 3;
+    }
+    for(int n=0; n<count; ++n){
+        int b = 0;
+        int m = n;
+        bool inside = true;
+        for(int d=Dim-1; d>=0; --d){
+            int i = idx[d] + (m % 3) - 1;
+            m /= 3;
+            inside = inside && i >= 0 && i < extent[d];
+            b = b*extent[d] + i;
+        }
+        if(!inside || !bins[b].held){continue;}
+        double dist = boxDistance(b, x, point);
+        if(best == -1 || dist < distance){
+            best = b;
+            distance = dist;
+            nearest = point;
+        }
+    }
+    return best;
+}
+
+template<int Dim>
+void CoreField<Dim>::near(const Vec &x, double distance, std::vector<int> &found) const {
+    found.clear();
+    Index lo, hi;
+    for(int d=0; d<Dim; ++d){
+        lo[d] = std::max(static_cast<int>(std::floor((x[d] - distance)/binSize)) - first[d], 0);
+        hi[d] = std::min(static_cast<int>(std::floor((x[d] + distance)/binSize)) - first[d], extent[d]-1);
+        if(lo[d] > hi[d]){return;}
+    }
+    Index i = lo;
+    Vec point;
+    while(true){
+        int b = 0;
+        for(int d=Dim-1; d>=0; --d){
+            b = b*extent[d] + i[d];
+        }
+        if(boxDistance(b, x, point) <= distance){
+            found.push_back(b);
+        }
+        int d = 0;
+        while(d < Dim && ++i[d] > hi[d]){
+            i[d] = lo[d];
+            d++;
+        }
+        if(d == Dim){break;}
+    }
+}
+
+template<int Dim>
+uint64_t CoreField<Dim>::key(int b) const {
+    Index idx = index(b);
+    uint64_t h = 0;
+    for(int d=0; d<Dim; ++d){
+        h = crn::mix(h ^ static_cast<uint32_t>(idx[d]));
+    }
+    return crn::key(0, h, crn::core, 0);
+}
+
+template<int Dim>
+void CoreField<Dim>::hold(int b, int capacity) {
+    if(bins[b].held){return;}
+    bins[b].held = true;
+    bins[b].capacity = std::max(capacity, bins[b].alive + bins[b].dead);
+    numHeld++;
+}
+
+template<int Dim>
+void CoreField<Dim>::drop(int b) {
+    if(bins[b].held){
+        numHeld--;
+    }
+    bins[b] = CoreBin{};
+}
+
+template<int Dim>
+void CoreField<Dim>::absorb(int b, const Cell<Dim> &cell) {
+    CoreBin &bin = bins[b];
+    if(cell.state == -1){
+        bin.dead++;
+    } else{
+        bin.alive++;
+        bin.pdl1 += cell.pdl1;
+        bin.born += cell.timeBorn;
+    }
+    bin.capacity = std::max(bin.capacity, bin.alive + bin.dead);
+}
+
+template<int Dim>
+int CoreField<Dim>::cells() const {
+    int n = 0;
+    if(numHeld == 0){return n;}
+    for(auto &bin : bins){
+        n += bin.alive + bin.dead;
+    }
+    return n;
+}
+
+template<int Dim>
+void CoreField<Dim>::positionSum(std::array<double, Dim> &sum) const {
+    if(numHeld == 0){return;}
+    for(int b=0; b<size(); ++b){
+        int n = bins[b].alive + bins[b].dead;
+        if(n == 0){continue;}
+        Vec c = binCenter(b);
+        for(int d=0; d<Dim; ++d){
+            sum[d] += n*c[d];
+        }
+    }
+}
+
+template<int Dim>
+void CoreField<Dim>::write(std::ostream &out) const {
+    writeBinary(out, binSize);
+    writeBinary(out, numHeld);
+    writeBinary(out, first);
+    writeBinary(out, extent);
+    size_t n = bins.size();
+    writeBinary(out, n);
+    out.write(reinterpret_cast<const char*>(bins.data()), n*sizeof(CoreBin));
+}
+
+template<int Dim>
+void CoreField<Dim>::read(std::istream &in) {
+    readBinary(in, binSize);
+    readBinary(in, numHeld);
+    readBinary(in, first);
+    readBinary(in, extent);
+    size_t n;
+    readBinary(in, n);
+    bins.resize(n);
+    in.read(reinterpret_cast<char*>(bins.data()), n*sizeof(CoreBin));
+    if(!in){
+        throw std::runtime_error("CoreField::read -> checkpoint ended early");
+    }
+}
+
+template class CoreField<2>;
+template class CoreField<3>;
@@ -0,0 +1,309 @@
+#include "DiscreteImg.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+DiscreteImg::DiscreteImg(double gridSize, std::vector<std::vector<std::array<double, 3>>> layers, int bindingLayer) {
+    bl = bindingLayer;
+    scaledLayers = layers;
+    scaleLayers(gridSize);
+}
+
+void DiscreteImg::scaleLayers(double size) {
+    /*
+     * scales cell position to a discrete grid-size
+     * binds the grid to bl, cells outside of the binding layer's extent are dropped
+     */
+    double minX = 1e8;
+    double minY = 1e8;
+    double maxX = -1e8;
+    double maxY = -1e8;
+
+    for(int i=0; i<scaledLayers.size(); ++i){
+        if(bl != -1 && i != bl){continue;}
+        for(auto &p : scaledLayers[i]){
+            minX = std::min(minX, p[0]);
+            minY = std::min(minY, p[1]);
+            maxX = std::max(maxX, p[0]);
+            maxY = std::max(maxY, p[1]);
+        }
+    }
+
+    for(auto &l : scaledLayers){
+        std::vector<std::array<double, 3>> scaled;
+        for(auto &p : l){
+            if(p[0] < minX || p[0] > maxX || p[1] < minY || p[1] > maxY){continue;}
+            scaled.push_back({(p[0] - minX)/size, (p[1] - minY)/size, p[2]});
+        }
+        l = scaled;
+    }
+}
+
+std::vector<double> DiscreteImg::createGrids(int &sizeX, int &sizeY) {
+    /*
+     * creates a grid from scaledLayers
+     * each grid-site is a pixel, each layer is a channel
+     * later cells overwrite earlier ones in the same grid-site, as in the python version
+     */
+    sizeX = 0;
+    sizeY = 0;
+    for(auto &l : scaledLayers){
+        for(auto &p : l){
+            sizeX = std::max(sizeX, static_cast<int>(p[0]));
+            sizeY = std::max(sizeY, static_cast<int>(p[1]));
+        }
+    }
+    sizeX += 1;
+    sizeY += 1;
+
+    int cn = scaledLayers.size();
+    std::vector<double> grid(static_cast<size_t>(sizeX)*sizeY*cn, 0.0);
+    for(int k=0; k<cn; ++k){
+        for(auto &p : scaledLayers[k]){
+            int i = static_cast<int>(p[0]);
+            int j = static_cast<int>(p[1]);
+            grid[(static_cast<size_t>(i)*sizeY + j)*cn + k] = p[2];
+        }
+    }
+
+    return grid;
+}
+
+std::vector<double> DiscreteImg::smallGrids(int imSize, std::vector<size_t> &shape) {
+    /*
+     * creates cell grid then shrinks it to imSize
+     * imSize == 0 returns the full grid without normalizing, as in the python version
+     */
+    int sizeX, sizeY;
+    std::vector<double> grid = createGrids(sizeX, sizeY);
+    int cn = scaledLayers.size();
+    if(imSize == 0){
+        shape = {static_cast<size_t>(sizeX), static_cast<size_t>(sizeY), static_cast<size_t>(cn)};
+        return grid;
+    }
+
+    std::vector<double> small = resizeArea(grid, sizeX, sizeY, cn, imSize, imSize);
+    shape = {static_cast<size_t>(imSize), static_cast<size_t>(imSize), static_cast<size_t>(cn)};
+
+    for(int k=0; k<cn; ++k){
+        double maxV = 0;
+        for(size_t i=k; i<small.size(); i+=cn){
+            maxV = std::max(maxV, small[i]);
+        }
+        if(maxV == 0){continue;}
+        for(size_t i=k; i<small.size(); i+=cn){
+            small[i] /= maxV;
+        }
+    }
+
+    return small;
+}
+
+std::vector<double> DiscreteImg::resizeArea(const std::vector<double> &src, int rows, int cols, int cn, int dRows, int dCols) {
+    /*
+     * cv::resize with INTER_AREA
+     * shrinking (in both directions) averages the source pixels under each output pixel, weighted by overlap
+     * otherwise opencv falls back to a linear interpolation with area-style weights, reproduced here as well
+     * weights are kept in float like opencv does
+     */
+    std::vector<double> dst(static_cast<size_t>(dRows)*dCols*cn, 0.0);
+    double scaleX = static_cast<double>(cols)/dCols;
+    double scaleY = static_cast<double>(rows)/dRows;
+
+    if(scaleX >= 1 && scaleY >= 1){
+        // weights[d] = list of (source index, weight) for output index d
+        auto areaTab = [](int ssize, int dsize, double scale){
+            std::vector<std::vector<std::pair<int, float>>> tab(dsize);
+            for(int d=0; d<dsize; ++d){
+                double fs1 = d*scale;
+                double fs2 = fs1 + scale;
+                double cellWidth = std::min(scale, ssize - fs1);
+                int s1 = static_cast<int>(std::ceil(fs1));
+                int s2 = static_cast<int>(std::floor(fs2));
+                s2 = std::min(s2, ssize - 1);
+                s1 = std::min(s1, s2);
+                if(s1 - fs1 > 1e-3){
+                    tab[d].push_back({s1 - 1, static_cast<float>((s1 - fs1)/cellWidth)});
+                }
+                for(int s=s1; s<s2; ++s){
+                    tab[d].push_back({s, static_cast<float>(1.0/cellWidth)});
+                }
+                if(fs2 - s2 > 1e-3){
+                    tab[d].push_back({s2, static_cast<float>(std::min(std::min(fs2 - s2, 1.0), cellWidth)/cellWidth)});
+                }
+            }
+            return tab;
+        };
+        auto xTab = areaTab(cols, dCols, scaleX);
+        auto yTab = areaTab(rows, dRows, scaleY);
+
+        for(int dy=0; dy<dRows; ++dy){
+            for(auto &wy : yTab[dy]){
+                for(int dx=0; dx<dCols; ++dx){
+                    for(auto &wx : xTab[dx]){
+                        double w = static_cast<double>(wy.second)*wx.second;
+                        for(int k=0; k<cn; ++k){
+                            dst[(static_cast<size_t>(dy)*dCols + dx)*cn + k] += w*src[(static_cast<size_t>(wy.first)*cols + wx.first)*cn + k];
+                        }
+                    }
+                }
+            }
+        }
+        return dst;
+    }
+
+    // enlarging in at least one direction
+    auto linearTab = [](int ssize, int dsize, std::vector<int> &ofs, std::vector<float> &frac){
+        double invScale = static_cast<double>(dsize)/ssize;
+        double scale = 1.0/invScale;
+        ofs.resize(dsize);
+        frac.resize(dsize);
+        for(int d=0; d<dsize; ++d){
+            int s = static_cast<int>(std::floor(d*scale));
+            float f = static_cast<float>((d+1) - (s+1)*invScale);
+            f = f <= 0 ? 0.f : f - std::floor(f);
+            if(s >= ssize - 1){
+                f = 0;
+                s = ssize - 1;
+            }
+            ofs[d] = s;
+            frac[d] = f;
+        }
+    };
+    std::vector<int> xOfs, yOfs;
+    std::vector<float> xFrac, yFrac;
+    linearTab(cols, dCols, xOfs, xFrac);
+    linearTab(rows, dRows, yOfs, yFrac);
+
+    for(int dy=0; dy<dRows; ++dy){
+        int sy0 = std::min(yOfs[dy], rows - 1);
+        int sy1 = std::min(yOfs[dy] + 1, rows - 1);
+        double b0 = 1.f - yFrac[dy];
+        double b1 = yFrac[dy];
+        for(int dx=0; dx<dCols; ++dx){
+            int sx0 = xOfs[dx];
+            int sx1 = std::min(sx0 + 1, cols - 1);
+            double a0 = 1.f - xFrac[dx];
+            double a1 = xFrac[dx];
+            for(int k=0; k<cn; ++k){
+                double r0 = a0*src[(static_cast<size_t>(sy0)*cols + sx0)*cn + k] + a1*src[(static_cast<size_t>(sy0)*cols + sx1)*cn + k];
+                double r1 = a0*src[(static_cast<size_t>(sy1)*cols + sx0)*cn + k] + a1*src[(static_cast<size_t>(sy1)*cols + sx1)*cn + k];
+                dst[(static_cast<size_t>(dy)*dCols + dx)*cn + k] = b0*r0 + b1*r1;
+            }
+        }
+    }
+    return dst;
+}
+
+std::string DiscreteImg::npyHeader(const std::vector<size_t> &shape) {
+    /*
+     * magic, version 1.0, header length, and the header dict for a little-endian float64 array
+     * padded so the data starts on a multiple of 64 bytes
+     */
+    std::ostringstream dims;
+    for(size_t i=0; i<shape.size(); ++i){
+        dims << shape[i] << ((shape.size() == 1 || i+1 < shape.size()) ? "," : "");
+        if(i+1 < shape.size()){dims << " ";}
+    }
+    std::string header = "{'descr': '<f8', 'fortran_order': False, 'shape': (" + dims.str() + "), }";
+    size_t total = 10 + header.size() + 1;
+    header += std::string((64 - total%64)%64, ' ') + "\n";
+
+    unsigned short headerLen = static_cast<unsigned short>(header.size());
+    std::string out = "\x93NUMPY";
+    out += '\x01';
+    out += '\x00';
+    out += static_cast<char>(headerLen & 0xff);
+    out += static_cast<char>(headerLen >> 8);
+    return out + header;
+}
+
+void DiscreteImg::saveNpy(std::string file, const std::vector<double> &data, const std::vector<size_t> &shape) {
+    // writes the array in numpy's .npy format
+    std::ofstream out(file, std::ios::binary);
+    if(!out){
+        throw std::runtime_error("DiscreteImg::saveNpy -> unable to open "+file);
+    }
+    std::string header = npyHeader(shape);
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(data.data()), data.size()*sizeof(double));
+}
+
+// descriptor closed when it goes out of scope, so no path out of saveNpySlot leaks it
+struct ScopedFd{
+    int fd;
+    explicit ScopedFd(int fd) : fd(fd) {}
+    ScopedFd(const ScopedFd&) = delete;
+    ScopedFd &operator=(const ScopedFd&) = delete;
+    ~ScopedFd(){
+        if(fd >= 0){
+            close(fd);
+        }
+    }
+};
+
+void DiscreteImg::saveNpySlot(std::string file, size_t slot, size_t nSlots, const std::vector<double> &data, const std::vector<size_t> &shape, char flag) {
+    /*
+     * writes one image into a shared (nSlots, shape...) .npy file through a memory map
+     * the first writer creates the file at full size under an exclusive lock, later writers check the header matches
+     * once the slot is written, byte slot of file.ready is set to flag, so readers know which slots are filled
+     */
+    std::vector<size_t> batchShape = {nSlots};
+    batchShape.insert(batchShape.end(), shape.begin(), shape.end());
+    std::string header = npyHeader(batchShape);
+    size_t slotBytes = data.size()*sizeof(double);
+    size_t totalBytes = header.size() + nSlots*slotBytes;
+    if(slot >= nSlots){
+        throw std::runtime_error("DiscreteImg::saveNpySlot -> slot outside of "+file);
+    }
+
+    ScopedFd dataFile(open(file.c_str(), O_RDWR | O_CREAT, 0644));
+    ScopedFd readyFile(open((file+".ready").c_str(), O_RDWR | O_CREAT, 0644));
+    int fd = dataFile.fd;
+    int readyFd = readyFile.fd;
+    if(fd < 0 || readyFd < 0){
+        throw std::runtime_error("DiscreteImg::saveNpySlot -> unable to open "+file);
+    }
+
+    flock(fd, LOCK_EX);
+    struct stat st;
+    fstat(fd, &st);
+    if(st.st_size == 0){
+        if(pwrite(fd, header.data(), header.size(), 0) != static_cast<ssize_t>(header.size()) ||
+           ftruncate(fd, totalBytes) != 0 || ftruncate(readyFd, nSlots) != 0){
+            flock(fd, LOCK_UN);
+            throw std::runtime_error("DiscreteImg::saveNpySlot -> unable to allocate "+file);
+        }
+    } else{
+        std::string existing(header.size(), '\0');
+        if(static_cast<size_t>(st.st_size) != totalBytes ||
+           pread(fd, &existing[0], header.size(), 0) != static_cast<ssize_t>(header.size()) || existing != header){
+            flock(fd, LOCK_UN);
+            throw std::runtime_error("DiscreteImg::saveNpySlot -> "+file+" was allocated with a different shape");
+        }
+    }
+    flock(fd, LOCK_UN);
+
+    // map only the pages holding this slot
+    size_t start = header.size() + slot*slotBytes;
+    size_t pageStart = start - start%sysconf(_SC_PAGESIZE);
+    size_t mapBytes = start - pageStart + slotBytes;
+    void *map = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, pageStart);
+    if(map == MAP_FAILED){
+        throw std::runtime_error("DiscreteImg::saveNpySlot -> unable to map "+file);
+    }
+    std::memcpy(static_cast<char*>(map) + (start - pageStart), data.data(), slotBytes);
+    munmap(map, mapBytes);
+
+    if(pwrite(readyFd, &flag, 1, slot) != 1){
+        throw std::runtime_error("DiscreteImg::saveNpySlot -> unable to mark slot in "+file+".ready");
+    }
+}
@@ -0,0 +1,214 @@
+#include "Domain.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+void Domain::start(int &argc, char **&argv) {
+#ifdef USE_MPI
+    // MPI is only called between the OpenMP regions, from the thread that started it
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+#else
+    (void)argc;
+    (void)argv;
+#endif
+}
+
+void Domain::stop() {
+#ifdef USE_MPI
+    int started;
+    MPI_Initialized(&started);
+    if(started){
+        MPI_Finalize();
+    }
+#endif
+}
+
+Domain::Domain() {
+    myRank = 0;
+    numRanks = 1;
+#ifdef USE_MPI
+    int started;
+    MPI_Initialized(&started);
+    if(started){
+        MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+        MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+    }
+#endif
+    cuts.assign(numRanks-1, 0.0);
+}
+
+int Domain::owner(double x) const {
+    return static_cast<int>(std::upper_bound(cuts.begin(), cuts.end(), x) - cuts.begin());
+}
+
+void Domain::ranksNear(double x, double width, int &first, int &last) const {
+    first = owner(x-width);
+    last = owner(x+width);
+}
+
+void Domain::balance(const std::vector<double> &x) {
+    /*
+     * histogram of the positions over all ranks, with the cuts placed where the cumulative count
+     * passes each rank's share, so every slab holds about the same number of cells
+     */
+    if(!distributed()){return;}
+    double range[2] = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    for(double v : x){
+        range[0] = std::max(range[0], -v);
+        range[1] = std::max(range[1], v);
+    }
+    max(range, 2);
+    double lo = -range[0];
+    double hi = range[1];
+    if(lo > hi){return;}
+
+    const int bins = 4096;
+    double width = std::max(hi-lo, 1e-9)/bins;
+    std::vector<int> hist(bins, 0);
+    for(double v : x){
+        hist[std::min(bins-1, static_cast<int>((v-lo)/width))]++;
+    }
+    sum(hist.data(), bins);
+    long long total = 0;
+    for(int b=0; b<bins; ++b){
+        total += hist[b];
+    }
+
+    long long below = 0;
+    int r = 1;
+    for(int b=0; b<bins && r<numRanks; ++b){
+        below += hist[b];
+        while(r < numRanks && below*numRanks >= total*r){
+            cuts[r-1] = lo + (b+1)*width;
+            r++;
+        }
+    }
+}
+
+void Domain::sum(double *values, int n) const {
+#ifdef USE_MPI
+    if(distributed()){
+        MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    }
+#else
+    (void)values;
+    (void)n;
+#endif
+}
+
+void Domain::sum(int *values, int n) const {
+#ifdef USE_MPI
+    if(distributed()){
+        MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    }
+#else
+    (void)values;
+    (void)n;
+#endif
+}
+
+void Domain::max(double *values, int n) const {
+#ifdef USE_MPI
+    if(distributed()){
+        MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    }
+#else
+    (void)values;
+    (void)n;
+#endif
+}
+
+int Domain::broadcast(int value) const {
+#ifdef USE_MPI
+    if(distributed()){
+        MPI_Bcast(&value, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    }
+#endif
+    return value;
+}
+
+void Domain::broadcast(std::vector<char> &bytes) const {
+#ifdef USE_MPI
+    if(distributed()){
+        int n = broadcast(static_cast<int>(bytes.size()));
+        bytes.resize(n);
+        MPI_Bcast(bytes.data(), n, MPI_CHAR, 0, MPI_COMM_WORLD);
+    }
+#else
+    (void)bytes;
+#endif
+}
+
+void Domain::exchange(const std::vector<std::vector<char>> &send, std::vector<std::vector<char>> &recv) const {
+    recv.resize(numRanks);
+    if(!distributed()){
+        recv[0] = send[0];
+        return;
+    }
+#ifdef USE_MPI
+    std::vector<int> sendCounts(numRanks), recvCounts(numRanks), sendOffsets(numRanks, 0), recvOffsets(numRanks, 0);
+    for(int r=0; r<numRanks; ++r){
+        sendCounts[r] = static_cast<int>(send[r].size());
+    }
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+
+    std::vector<char> sendBuffer, recvBuffer;
+    for(int r=0; r<numRanks; ++r){
+        sendOffsets[r] = static_cast<int>(sendBuffer.size());
+        sendBuffer.insert(sendBuffer.end(), send[r].begin(), send[r].end());
+        recvOffsets[r] = r == 0 ? 0 : recvOffsets[r-1] + recvCounts[r-1];
+    }
+    recvBuffer.resize(recvOffsets[numRanks-1] + recvCounts[numRanks-1]);
+    MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendOffsets.data(), MPI_CHAR,
+                  recvBuffer.data(), recvCounts.data(), recvOffsets.data(), MPI_CHAR, MPI_COMM_WORLD);
+    for(int r=0; r<numRanks; ++r){
+        recv[r].assign(recvBuffer.begin()+recvOffsets[r], recvBuffer.begin()+recvOffsets[r]+recvCounts[r]);
+    }
+#endif
+}
+
+void Domain::gather(const std::vector<char> &mine, std::vector<char> &all) const {
+    if(!distributed()){
+        all = mine;
+        return;
+    }
+#ifdef USE_MPI
+    int n = static_cast<int>(mine.size());
+    std::vector<int> counts(numRanks), offsets(numRanks, 0);
+    MPI_Gather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    for(int r=1; r<numRanks; ++r){
+        offsets[r] = offsets[r-1] + counts[r-1];
+    }
+    all.resize(myRank == 0 ? offsets[numRanks-1] + counts[numRanks-1] : 0);
+    MPI_Gatherv(mine.data(), n, MPI_CHAR, all.data(), counts.data(), offsets.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+#endif
+}
+
+void Domain::allGather(const std::vector<char> &mine, std::vector<char> &all) const {
+    if(!distributed()){
+        all = mine;
+        return;
+    }
+#ifdef USE_MPI
+    int n = static_cast<int>(mine.size());
+    std::vector<int> counts(numRanks), offsets(numRanks, 0);
+    MPI_Allgather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for(int r=1; r<numRanks; ++r){
+        offsets[r] = offsets[r-1] + counts[r-1];
+    }
+    all.resize(offsets[numRanks-1] + counts[numRanks-1]);
+    MPI_Allgatherv(mine.data(), n, MPI_CHAR, all.data(), counts.data(), offsets.data(), MPI_CHAR, MPI_COMM_WORLD);
+#endif
+}
+
+void Domain::barrier() const {
+#ifdef USE_MPI
+    if(distributed()){
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+#endif
+}
@@ -0,0 +1,150 @@
+#include "Environment.h"
+#include "Checkpoint.h"
+#include <iomanip>
+
+/*
+ * BURN-IN CACHE
+ * -------------
+ * until the first CD8 is recruited only cancer cells are present, and they depend on a small subset of the parameters
+ * that early tumor is grown once per subset, stored as a checkpoint, and copied into every run that shares it
+ * runs never write to an existing entry, they load a private copy and continue from there
+ * models that start with CD8 in place (HypoxiaModel) cache just the initial tumor
+ */
+
+template<int Dim, class Model>
+std::string Environment<Dim, Model>::burnInKey(double tstep) {
+    /*
+     * parameters that act before the first CD8 arrives
+     *  the model
+     *  cancer mu, kc, damping, overlap, division, death, diameter, and hypoxia
+     *  CD8 recruitment rate (sets when the burn-in ends) and whether recruitment happens at all
+     *  dimension, precision, step sizes, and how often the tumor center moves
+     *  the depth of the hybrid core
+     * PD-L1 parameters are left out since PD-L1 is only gained next to active CD8
+     */
+    const CellTypeParams &cancer = params->cellTypes[0];
+    std::ostringstream key;
+    key << std::setprecision(17) << Model::name << ",";
+    for(double p : {cancer.mu, cancer.kc, cancer.damping, cancer.maxOverlap, cancer.divProb, cancer.deathProb,
+                    cancer.radius, cancer.hypoxicL, cancer.hypoxicP}){
+        key << p << ",";
+    }
+    key << cd8RecRate << "," << (cd8Ratio > 0) << "," << (Dim == 3) << "," << sizeof(real) << "," << tstep << "," << dt
+        << "," << options.dailyTumorCenter;
+    // keys of runs without the hybrid core stay as they were
+    if(options.coreDepth > 0){
+        key << "," << options.coreDepth;
+    }
+    return key.str();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::reseed() {
+    /*
+     * new random streams for the environment and every cell
+     * keeps runs that start from the same cached tumor independent of each other
+     * with common random numbers the streams follow the run's crnSeed instead
+     */
+    if(options.commonRandomNumbers){
+        mt.seed(static_cast<unsigned int>(crn::mix(options.crnSeed)));
+        for(auto &cell : cell_list){
+            cell.reseed(static_cast<unsigned int>(crn::key(options.crnSeed, cell.lineage, crn::stream, 0)));
+            cell.useCommonRandomNumbers(options.crnSeed);
+        }
+        return;
+    }
+    mt.seed((std::random_device())());
+    for(auto &cell : cell_list){
+        cell.reseed(mt());
+    }
+}
+
+template<int Dim, class Model>
+std::string Environment<Dim, Model>::burnInFile(const std::string &key) {
+    // FNV-1a hash of the key names the cache entry, the key itself is stored next to it
+    unsigned long long hash = 1469598103934665603ULL;
+    for(char c : key){
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream name;
+    name << options.burnInCache << "/burnin_" << std::hex << hash << std::dec << "_" << options.burnInSample;
+    return name.str();
+}
+
+template<int Dim, class Model>
+std::string Environment<Dim, Model>::burnInEntry(double tstep) {
+    if(options.burnInCache.empty()){
+        return "";
+    }
+    return burnInFile(burnInKey(effectiveStep(tstep)));
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::startFromBurnIn(double tstep) {
+    std::string key = burnInKey(tstep);
+    std::string name = burnInFile(key);
+    std::string file = name+".bin";
+    std::string keyFile = name+".key";
+
+    // cells are bound to this run's type parameters, so parameters outside the key take this run's values
+    auto load = [&](){
+        std::ifstream storedKey(keyFile);
+        std::string line;
+        std::getline(storedKey, line);
+        if(line != key){
+            throw std::runtime_error("Environment::startFromBurnIn -> cache entry "+file+" was grown with different parameters");
+        }
+        loadCheckpoint(file);
+        reseed();
+        if(domain.rank() == 0){
+            std::cout << "Burn-in: loaded " << file << " at day " << steps*tstep/24 << std::endl;
+        }
+    };
+
+    // rank 0 decides for all ranks whether the entry exists
+    std::ifstream cached(file, std::ios::binary);
+    if(domain.broadcast(cached.good() ? 1 : 0)){
+        cached.close();
+        load();
+        return;
+    }
+
+    // grow the tumor up to the step that would recruit the first CD8
+    initializeTumor();
+    while(tstep*steps/24 < simulationDuration && numCells(1) == 0 && cd82rec + recruitmentIncrement(tstep) < 1){
+        if(!runStep(tstep)){
+            break;
+        }
+    }
+
+    /*
+     * runs that missed the same entry at the same time each grow a tumor, the first to publish it wins
+     * the others load the winner's entry, so every run of the key starts from the same tumor
+     * key is published first, so a visible entry always has its key
+     */
+    if(domain.rank() == 0){
+        std::string str = "mkdir -p "+options.burnInCache;
+        std::system(str.c_str());
+        std::string tmpKey = writerTmpName(keyFile);
+        std::ofstream keyOut(tmpKey);
+        keyOut << key << std::endl;
+        keyOut.close();
+        publishFile(tmpKey, keyFile, false);
+    }
+    if(!domain.broadcast(writeCheckpoint(file, false) ? 1 : 0)){
+        dailyOutputs.clear();
+        stopReason.clear();
+        load();
+        return;
+    }
+
+    if(domain.rank() == 0){
+        std::cout << "Burn-in: stored " << file << " at day " << steps*tstep/24 << std::endl;
+    }
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
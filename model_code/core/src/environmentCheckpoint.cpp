@@ -0,0 +1,171 @@
+#include "Environment.h"
+#include "Checkpoint.h"
+#include <cstdio>
+
+/*
+ * binary checkpoints of the full simulation state
+ * -----------------------------------------------
+ * parameters are not stored, they are loaded from saveDir/params as usual and cells are bound to them on load
+ * the file is written next to its destination under a name private to the writer and renamed,
+ * so a job killed mid-write leaves the old checkpoint intact and concurrent writers never share a file
+ * with several ranks rank 0 writes the cells of all ranks, and on load they are split over the slabs again,
+ * so a checkpoint can be continued on any number of ranks
+ * the hybrid core is stored as its counts
+ * below full fidelity the neighbor lists kept between rebuilds are stored too, so a restart between rebuilds stays exact
+ */
+
+static const char checkpointTag[8] = {'A','B','M','C','K','P','T','8'};
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::saveCheckpoint(std::string file) {
+    writeCheckpoint(file, true);
+}
+
+template<int Dim, class Model>
+bool Environment<Dim, Model>::writeCheckpoint(const std::string &file, bool replace) {
+    // only rank 0 writes, the other ranks return true
+    double start = omp_get_wtime();
+    CellList<Dim> gathered;
+    if(domain.distributed()){
+        gatherCells(gathered);
+        if(domain.rank() != 0){return true;}
+    }
+    const CellList<Dim> &cells = domain.distributed() ? gathered : cell_list;
+
+    std::string tmpFile = writerTmpName(file);
+    std::ofstream out(tmpFile, std::ios::binary);
+    if(!out){
+        throw std::runtime_error("Environment::saveCheckpoint -> unable to open "+tmpFile);
+    }
+
+    out.write(checkpointTag, sizeof(checkpointTag));
+    double threeD = Dim == 3 ? 1.0 : 0.0;
+    writeBinary(out, threeD);
+    int precision = sizeof(real);
+    writeBinary(out, precision);
+    writeBinary(out, steps);
+    writeBinary(out, cd82rec);
+    writeBinary(out, timerStep);
+    writeBinary(out, tumorRadius);
+    writeBinary(out, tumorCenter);
+    writeBinary(out, mt);
+
+    size_t numEdge = edgeCells.size();
+    writeBinary(out, numEdge);
+    out.write(reinterpret_cast<const char*>(edgeCells.data()), numEdge*sizeof(Vec));
+
+    size_t numCells = cells.size();
+    writeBinary(out, numCells);
+    for(auto &cell : cells){
+        cell.writeState(out);
+    }
+    // with several ranks the lists are never kept
+    bool keptNeighbors = neighborsValid && !domain.distributed();
+    writeBinary(out, keptNeighbors);
+    if(keptNeighbors){
+        size_t numIndices = neighborIndices.size();
+        writeBinary(out, numIndices);
+        out.write(reinterpret_cast<const char*>(neighborIndices.data()), numIndices*sizeof(int));
+        for(auto &cell : cells){
+            writeBinary(out, cell.neighborStart);
+            writeBinary(out, cell.neighborCount);
+        }
+    }
+    core.write(out);
+    out.close();
+    if(!out){
+        std::remove(tmpFile.c_str());
+        throw std::runtime_error("Environment::saveCheckpoint -> failed writing "+tmpFile);
+    }
+
+    if(!publishFile(tmpFile, file, replace)){
+        return false;
+    }
+
+    if(options.verbose){
+        std::cout << "Checkpoint: " << file << " (" << numCells << " cells, "
+                  << omp_get_wtime() - start << " s)" << std::endl;
+    }
+    return true;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::loadCheckpoint(std::string file) {
+    std::ifstream in(file, std::ios::binary);
+    if(!in){
+        throw std::runtime_error("Environment::loadCheckpoint -> unable to open "+file);
+    }
+
+    char tag[sizeof(checkpointTag)];
+    in.read(tag, sizeof(tag));
+    if(!in || !std::equal(tag, tag+sizeof(tag), checkpointTag)){
+        throw std::runtime_error("Environment::loadCheckpoint -> not a checkpoint file: "+file);
+    }
+
+    double savedThreeD;
+    readBinary(in, savedThreeD);
+    if(savedThreeD != (Dim == 3 ? 1.0 : 0.0)){
+        throw std::runtime_error("Environment::loadCheckpoint -> checkpoint dimension does not match envParams");
+    }
+    int savedPrecision;
+    readBinary(in, savedPrecision);
+    if(savedPrecision != sizeof(real)){
+        throw std::runtime_error("Environment::loadCheckpoint -> checkpoint was written with a different SINGLE_PRECISION setting");
+    }
+    readBinary(in, steps);
+    readBinary(in, cd82rec);
+    readBinary(in, timerStep);
+    readBinary(in, tumorRadius);
+    readBinary(in, tumorCenter);
+    readBinary(in, mt);
+
+    size_t numEdge;
+    readBinary(in, numEdge);
+    edgeCells.resize(numEdge);
+    in.read(reinterpret_cast<char*>(edgeCells.data()), numEdge*sizeof(Vec));
+
+    size_t numCells;
+    readBinary(in, numCells);
+    cell_list.resize(numCells);
+    for(auto &cell : cell_list){
+        cell.readState(in);
+        if(cell.type != 0 && cell.type != 1){
+            throw std::runtime_error("Environment::loadCheckpoint -> unknown cell type in "+file);
+        }
+    }
+    bindCellTypes();
+    bool keptNeighbors;
+    readBinary(in, keptNeighbors);
+    if(keptNeighbors){
+        size_t numIndices;
+        readBinary(in, numIndices);
+        neighborIndices.resize(numIndices);
+        in.read(reinterpret_cast<char*>(neighborIndices.data()), numIndices*sizeof(int));
+        for(auto &cell : cell_list){
+            readBinary(in, cell.neighborStart);
+            readBinary(in, cell.neighborCount);
+        }
+    }
+    // lists carry over only below full fidelity on a single rank
+    neighborsValid = keptNeighbors && fidelityScale > 1 && !domain.distributed();
+    core.read(in);
+    if(!in){
+        throw std::runtime_error("Environment::loadCheckpoint -> checkpoint ended early: "+file);
+    }
+    // held cells continue as cells in runs without the hybrid core
+    if(options.coreDepth <= 0 || domain.distributed()){
+        releaseCore();
+    }
+    distribute();
+    recount();
+
+    initialized = true;
+    if(domain.rank() == 0){
+        std::cout << "Restarting from " << file << " at step " << steps << std::endl;
+    }
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
@@ -0,0 +1,338 @@
+#include "Environment.h"
+
+/*
+ * HYBRID CORE
+ * -----------
+ * with RunOptions::coreDepth the deep, compressed part of a large tumor is held as counts (CoreField.h)
+ *  placeCore - once a day, bins more than coreDepth inside the edge cells and farther than coreGuard from every CD8
+ *   join the core and absorb their cancer cells, held bins that no longer qualify are released as cells again
+ *  guardCore - every step, held bins a CD8 could reach during the step are released, so kills, inhibition,
+ *   and PD-L1 gain only ever involve cells
+ *  stepCore - held cells age and die (coreDeath of the model on top), and divide into the room their bin has left
+ *   cells divide until they are compressed, so a bin has room for the cells of a hexagonal (3D: fcc) lattice
+ *   whose overlaps add up to maxOverlap per cell, or for the cells pushed into it if more
+ *  coreWall - mechanics, each cell next to the core feels it as one cancer cell just inside the closest held bin,
+ *   scaled by how full that bin is, so the rim rests on a full core and moves into one that lost cells
+ *  cells pushed into a held bin are absorbed (internalCellFunctions)
+ * held cells count towards population, the tumor center, and recruitment, they are laid out on a lattice
+ * in their bin for outputs (heldCells) and when released
+ *
+ * the neighbor search and forces, most of the cost of a large tumor, then only run over the rim and the stroma
+ * held cells keep the mean PD-L1 and birth time of their bin, their positions inside the bin are not tracked
+ */
+
+static int binomialInverse(int n, double p, double u) {
+    // number of successes of n trials with probability p, by inversion of the cdf at u
+    if(n <= 0 || p <= 0){return 0;}
+    if(p >= 1){return n;}
+    double ratio = p/(1 - p);
+    double pk = std::pow(1 - p, n);
+    double cdf = pk;
+    int k = 0;
+    while(cdf <= u && k < n){
+        pk *= ratio*(n - k)/(k + 1.0);
+        k++;
+        cdf += pk;
+    }
+    return k;
+}
+
+template<int Dim, class Model>
+double Environment<Dim, Model>::coreGuard(double tstep) {
+    /*
+     * distance CD8 keep from held bins, their contact with cancer cells and, with influences, their influence radius,
+     * plus a step of migration and a cell diameter for released cells to settle
+     */
+    const CellTypeParams &cancer = params->cellTypes[0];
+    const CellTypeParams &cd8 = params->cellTypes[1];
+    double reach = std::max(cancer.radius + cd8.radius, std::max(cancer.rmax, cd8.rmax));
+    if(Model::influence){
+        reach = std::max(reach, cd8.influenceRadius);
+    }
+    return reach + cd8.migrationSpeed*tstep + 2*cancer.radius;
+}
+
+template<int Dim, class Model>
+double Environment<Dim, Model>::coreDraw(uint64_t key, crn::Event event) {
+    if(options.commonRandomNumbers){
+        return crn::uniform(crn::key(options.crnSeed, key, event, steps));
+    }
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    return dis(mt);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::placeCore(double tstep) {
+    if(options.coreDepth <= 0){return;}
+    if(edgeCells.empty() || worldPopulation.total(0) == 0){
+        releaseCore();
+        return;
+    }
+
+    // bins are at least two cell diameters and every rmax wide, see CoreField::nearestHeld
+    double width = 4*params->cellTypes[0].radius;
+    for(const CellTypeParams &p : params->cellTypes){
+        width = std::max(width, p.rmax);
+    }
+    core.cover(tumorCenter, tumorRadius + width, width);
+
+    // deep bins lie wholly within tumorRadius - coreDepth and more than coreDepth from every edge cell
+    double depth = options.coreDepth;
+    double half = 0.5*width*std::sqrt(static_cast<double>(Dim));
+    double minEdge = std::numeric_limits<double>::max();
+    for(const Vec &e : edgeCells){
+        double distance2 = 0;
+        for(int d=0; d<Dim; ++d){
+            distance2 += (e[d] - tumorCenter[d])*(e[d] - tumorCenter[d]);
+        }
+        minEdge = std::min(minEdge, std::sqrt(distance2));
+    }
+    std::vector<char> deep(core.size(), 0);
+#pragma omp parallel for if(parallel)
+    for(int b=0; b<core.size(); ++b){
+        Vec c = core.binCenter(b);
+        double distance2 = 0;
+        for(int d=0; d<Dim; ++d){
+            distance2 += (c[d] - tumorCenter[d])*(c[d] - tumorCenter[d]);
+        }
+        double fromCenter = std::sqrt(distance2);
+        if(fromCenter + half > tumorRadius - depth){continue;}
+        // edge cells are at least minEdge from the center, so bins well inside need no search
+        bool isDeep = fromCenter + half < minEdge - depth;
+        if(!isDeep){
+            isDeep = true;
+            for(const Vec &e : edgeCells){
+                double edge2 = 0;
+                for(int d=0; d<Dim; ++d){
+                    edge2 += (c[d] - e[d])*(c[d] - e[d]);
+                }
+                if(std::sqrt(edge2) - half <= depth){
+                    isDeep = false;
+                    break;
+                }
+            }
+        }
+        deep[b] = isDeep;
+    }
+    double guard = coreGuard(tstep);
+    std::vector<int> found;
+    for(auto &cell : cell_list){
+        if(cell.type != 1){continue;}
+        core.near(cell.x, guard, found);
+        for(int b : found){
+            deep[b] = 0;
+        }
+    }
+
+    // release first, so released cells are not absorbed again
+    for(int b=0; b<core.size(); ++b){
+        if(core.bins[b].held && !deep[b]){
+            releaseBin(b);
+        }
+    }
+    spareCells.clear();
+    for(auto &cell : cell_list){
+        int b = cell.type == 0 ? core.find(cell.x) : -1;
+        if(b >= 0 && deep[b]){
+            core.absorb(b, cell);
+        } else{
+            spareCells.push_back(cell);
+        }
+    }
+    cell_list.swap(spareCells);
+
+    // packing at the compression threshold, the fraction of a cell over is kept with probability equal to it
+    const CellTypeParams &cancer = params->cellTypes[0];
+    double spacing = 2*cancer.radius - cancer.maxOverlap/(Dim == 3 ? 12 : 6);
+    double perCell = Dim == 3 ? spacing*spacing*spacing/std::sqrt(2.0) : 0.5*std::sqrt(3.0)*spacing*spacing;
+    double packing = std::pow(width, Dim)/perCell;
+    for(int b=0; b<core.size(); ++b){
+        if(deep[b]){
+            double u = crn::uniform(crn::key(0, core.key(b), crn::core, 0, Dim));
+            core.hold(b, static_cast<int>(packing + u));
+        }
+    }
+    for(int i=0; i<cell_list.size(); ++i){
+        cell_list[i].updateID(i);
+    }
+    neighborsValid = false;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::guardCore(double tstep) {
+    // CD8 move up to a step of migration before the next check, which coreGuard includes
+    if(core.empty()){return;}
+    double guard = coreGuard(tstep);
+    std::vector<int> found;
+    int numCells = cell_list.size();
+    bool released = false;
+    for(int i=0; i<numCells; ++i){
+        if(cell_list[i].type != 1){continue;}
+        core.near(cell_list[i].x, guard, found);
+        for(int b : found){
+            if(core.bins[b].held){
+                releaseBin(b);
+                released = true;
+            }
+        }
+    }
+    if(released){
+        neighborsValid = false;
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::stepCore(double tstep) {
+    /*
+     * aging and model deaths of the living held cells, then division of the survivors into the room left
+     * one draw per bin and event, the counts follow by inverting their binomial distributions
+     */
+    if(core.empty()){return;}
+    const StepProbabilities &step = stepProbs[0];
+    const CellTypeParams &cancer = params->cellTypes[0];
+    double time = static_cast<double>(steps)*tstep/24;
+    int died = 0;
+    int born = 0;
+    for(int b=0; b<core.size(); ++b){
+        CoreBin &bin = core.bins[b];
+        if(!bin.held || bin.alive == 0){continue;}
+        uint64_t key = core.key(b);
+        double pdl1 = bin.pdl1/bin.alive;
+        double timeBorn = bin.born/bin.alive;
+
+        int deaths = binomialInverse(bin.alive, step.death, coreDraw(key, crn::death));
+        double pModel = Model::template coreDeath<Dim>(core.binCenter(b), tumorCenter, cancer, step);
+        deaths += binomialInverse(bin.alive - deaths, pModel, coreDraw(key, crn::hypoxia));
+        int alive = bin.alive - deaths;
+        if(!Model::removeDeadCells){
+            bin.dead += deaths;
+        }
+
+        int room = std::max(bin.capacity - alive - bin.dead, 0);
+        int births = std::min(binomialInverse(alive, step.division, coreDraw(key, crn::proliferation)), room);
+
+        bin.alive = alive + births;
+        bin.pdl1 = pdl1*bin.alive;
+        bin.born = timeBorn*alive + time*births;
+        died += deaths;
+        born += births;
+    }
+    population.move(0, 0, -1, died);
+    if(Model::removeDeadCells){
+        population.add(0, -1, -died);
+    }
+    population.add(0, 0, born);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::releaseCore() {
+    if(core.empty()){return;}
+    for(int b=0; b<core.size(); ++b){
+        if(core.bins[b].held){
+            releaseBin(b);
+        }
+    }
+    neighborsValid = false;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::releaseBin(int b) {
+    // held cells become cells again, population already counts them
+    placeHeld(b, cell_list, true);
+    core.drop(b);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::placeHeld(int b, CellList<Dim> &into, bool release) {
+    /*
+     * cells of bin b on the smallest lattice with room for them, jittered by a quarter spacing,
+     * with the dead spread evenly over the slots
+     * positions only depend on the bin and its counts, so outputs of unchanged bins do not move between days
+     * released cells get new lineages and random streams, output copies draw nothing
+     */
+    const CoreBin &bin = core.bins[b];
+    int n = bin.alive + bin.dead;
+    if(n == 0){return;}
+    int m = 1;
+    while(std::pow(m, Dim) < n){
+        m++;
+    }
+    double spacing = core.binSize/m;
+    uint64_t key = core.key(b);
+    Vec corner = core.binCenter(b);
+    for(int d=0; d<Dim; ++d){
+        corner[d] -= 0.5*core.binSize;
+    }
+    double pdl1 = bin.alive > 0 ? bin.pdl1/bin.alive : 0;
+    double timeBorn = bin.alive > 0 ? bin.born/bin.alive : 0;
+
+    for(int k=0; k<n; ++k){
+        Vec loc;
+        int slot = k;
+        for(int d=0; d<Dim; ++d){
+            double jitter = 0.5*crn::uniform(crn::key(0, key, crn::core, k, d)) - 0.25;
+            loc[d] = corner[d] + (slot % m + 0.5 + jitter)*spacing;
+            slot /= m;
+        }
+        bool dead = (k+1)*bin.dead/n > k*bin.dead/n;
+        uint64_t lineage = crn::key(0, key, crn::core, steps, k);
+        Cell<Dim> cell = release ? newCell(loc, "cancer", timeBorn, lineage)
+                                 : Cell<Dim>(loc, static_cast<int>(into.size()), &params->cellTypes[0], timeBorn, 0);
+        cell.lineage = lineage;
+        if(dead){
+            cell.state = -1;
+        } else{
+            cell.pdl1 = pdl1;
+        }
+        into.push_back(cell);
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::heldCells(CellList<Dim> &into) {
+    // held cells laid out as cells, for outputs
+    for(int b=0; b<core.size(); ++b){
+        if(core.bins[b].held){
+            placeHeld(b, into, false);
+        }
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::coreWall(Cell<Dim> &cell, bool overlap) {
+    /*
+     * the closest held bin acts as a cancer cell whose surface touches the bin at the point closest to the cell,
+     * its force (or overlap) is scaled by the bin's fill
+     * cells inside a held bin are left to the cells around them until they are absorbed
+     */
+    Vec nearest;
+    double distance;
+    int b = core.nearestHeld(cell.x, nearest, distance);
+    if(b < 0 || distance <= 0){return;}
+    const CoreBin &bin = core.bins[b];
+    if(bin.capacity == 0){return;}
+    double fill = std::min(1.0, static_cast<double>(bin.alive + bin.dead)/bin.capacity);
+
+    double radius = params->cellTypes[0].radius;
+    Vec virtualX;
+    for(int d=0; d<Dim; ++d){
+        virtualX[d] = nearest[d] - radius*(cell.x[d] - nearest[d])/distance;
+    }
+    if(overlap){
+        double before = cell.currentOverlap;
+        cell.calculateOverlap(virtualX, radius);
+        cell.currentOverlap = before + fill*(cell.currentOverlap - before);
+        return;
+    }
+    Vec before = cell.currentForces;
+    int cancerType = 0;
+    cell.calculateForces(virtualX, radius, cancerType);
+    for(int d=0; d<Dim; ++d){
+        cell.currentForces[d] = before[d] + fill*(cell.currentForces[d] - before[d]);
+    }
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
@@ -0,0 +1,238 @@
+#include "Environment.h"
+#include <cstring>
+#include <type_traits>
+
+/*
+ * DOMAIN DECOMPOSITION
+ * --------------------
+ * with several ranks (see Domain.h) every rank steps the cells of its slab
+ *  exchangeHalo - cells within haloWidth of another rank's slab are copied there as ghosts
+ *  neighbors, contacts, the CD8 sweep, and forces of the owned cells, with ghosts among their neighbors
+ *   ghost positions are refreshed after every move (updateHalo), kills of ghosts go to their owners (applyGhostKills)
+ *  dropHalo, then aging, division, and removal of the owned cells
+ *  migrateCells - cells that left the slab move to their new owner
+ * tumor center, radius, edge cells, and cell counts are combined over all ranks, so every rank uses the same values
+ * recruits are placed on rank 0 and reach their owners with migrateCells, rank 0 writes every output and checkpoint
+ *
+ * haloWidth covers the neighbor range, so owned cells see the same neighbors and contacts as in a single process
+ * influences, which a single process sums over every cell, stop at haloWidth (3 influence radii, below probTh^3)
+ * sums over neighbors run in another order, so runs agree with a single process statistically, not draw for draw
+ * with one rank numOwned is the whole list and every function here returns right away
+ */
+
+template<int Dim, class Model>
+std::vector<char> Environment<Dim, Model>::packCells(const std::vector<int> &indices) {
+    // cells are plain data, only the type parameter pointer has to be rebound on arrival
+    static_assert(std::is_trivially_copyable<Cell<Dim>>::value, "Environment::packCells -> cells have to be trivially copyable");
+    std::vector<char> bytes(indices.size()*sizeof(Cell<Dim>));
+    for(size_t k=0; k<indices.size(); ++k){
+        std::memcpy(bytes.data()+k*sizeof(Cell<Dim>), &cell_list[indices[k]], sizeof(Cell<Dim>));
+    }
+    return bytes;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::unpackCells(const std::vector<char> &bytes, CellList<Dim> &into) {
+    size_t n = bytes.size()/sizeof(Cell<Dim>);
+    for(size_t k=0; k<n; ++k){
+        Cell<Dim> cell;
+        std::memcpy(&cell, bytes.data()+k*sizeof(Cell<Dim>), sizeof(Cell<Dim>));
+        cell.typeParams = &params->cellTypes[cell.type];
+        cell.updateID(static_cast<int>(into.size()));
+        into.push_back(cell);
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::exchangeHalo() {
+    numOwned = static_cast<int>(cell_list.size());
+    if(!domain.distributed()){return;}
+
+    int ranks = domain.size();
+    haloSend.resize(ranks);
+    for(auto &list : haloSend){
+        list.clear();
+    }
+    for(int i=0; i<numOwned; ++i){
+        int first, last;
+        domain.ranksNear(cell_list[i].x[0], haloWidth, first, last);
+        for(int r=first; r<=last; ++r){
+            if(r != domain.rank()){
+                haloSend[r].push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::vector<char>> send(ranks), recv;
+    for(int r=0; r<ranks; ++r){
+        send[r] = packCells(haloSend[r]);
+    }
+    domain.exchange(send, recv);
+
+    ghostRank.clear();
+    ghostSlot.clear();
+    for(int r=0; r<ranks; ++r){
+        int n = static_cast<int>(recv[r].size()/sizeof(Cell<Dim>));
+        unpackCells(recv[r], cell_list);
+        for(int k=0; k<n; ++k){
+            ghostRank.push_back(r);
+            ghostSlot.push_back(k);
+        }
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::updateHalo() {
+    // ghosts keep their order from exchangeHalo, so only the positions are sent
+    if(!domain.distributed()){return;}
+    int ranks = domain.size();
+    std::vector<std::vector<char>> send(ranks), recv;
+    for(int r=0; r<ranks; ++r){
+        send[r].resize(haloSend[r].size()*sizeof(Vec));
+        for(size_t k=0; k<haloSend[r].size(); ++k){
+            std::memcpy(send[r].data()+k*sizeof(Vec), &cell_list[haloSend[r][k]].x, sizeof(Vec));
+        }
+    }
+    domain.exchange(send, recv);
+
+    int g = numOwned;
+    for(int r=0; r<ranks; ++r){
+        size_t n = recv[r].size()/sizeof(Vec);
+        for(size_t k=0; k<n; ++k){
+            std::memcpy(&cell_list[g++].x, recv[r].data()+k*sizeof(Vec), sizeof(Vec));
+        }
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::dropHalo() {
+    cell_list.erase(cell_list.begin()+numOwned, cell_list.end());
+}
+
+template<int Dim, class Model>
+int Environment<Dim, Model>::applyGhostKills() {
+    /*
+     * kills of ghosts go back to the rank owning the cell
+     * a cell killed on several ranks, or also by its own rank, dies once
+     * returns the number of owned cells that died here
+     */
+    if(!domain.distributed()){return 0;}
+    int ranks = domain.size();
+    std::vector<std::vector<char>> send(ranks), recv;
+    for(int g : ghostKills){
+        int slot = ghostSlot[g-numOwned];
+        std::vector<char> &bytes = send[ghostRank[g-numOwned]];
+        bytes.insert(bytes.end(), reinterpret_cast<const char*>(&slot), reinterpret_cast<const char*>(&slot)+sizeof(int));
+    }
+    ghostKills.clear();
+    domain.exchange(send, recv);
+
+    int killed = 0;
+    for(int r=0; r<ranks; ++r){
+        for(size_t k=0; k<recv[r].size()/sizeof(int); ++k){
+            int slot;
+            std::memcpy(&slot, recv[r].data()+k*sizeof(int), sizeof(int));
+            Cell<Dim> &cell = cell_list[haloSend[r][slot]];
+            if(cell.state != -1){
+                cell.state = -1;
+                killed++;
+            }
+        }
+    }
+    return killed;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::migrateCells() {
+    // owned cells outside this rank's slab are sent to the rank that owns their position
+    if(!domain.distributed()){return;}
+    int ranks = domain.size();
+    std::vector<std::vector<int>> leaving(ranks);
+    spareCells.clear();
+    for(int i=0; i<cell_list.size(); ++i){
+        int r = domain.owner(cell_list[i].x[0]);
+        if(r == domain.rank()){
+            spareCells.push_back(cell_list[i]);
+        } else{
+            leaving[r].push_back(i);
+            population.add(cell_list[i].type, cell_list[i].state, -1);
+        }
+    }
+
+    std::vector<std::vector<char>> send(ranks), recv;
+    for(int r=0; r<ranks; ++r){
+        send[r] = packCells(leaving[r]);
+    }
+    domain.exchange(send, recv);
+
+    cell_list.swap(spareCells);
+    for(int r=0; r<ranks; ++r){
+        size_t first = cell_list.size();
+        unpackCells(recv[r], cell_list);
+        for(size_t i=first; i<cell_list.size(); ++i){
+            population.add(cell_list[i].type, cell_list[i].state);
+        }
+    }
+    for(int i=0; i<cell_list.size(); ++i){
+        cell_list[i].updateID(i);
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::rebalance() {
+    // slabs of equal cell counts for the current tumor
+    if(!domain.distributed()){return;}
+    std::vector<double> x(cell_list.size());
+    for(int i=0; i<cell_list.size(); ++i){
+        x[i] = cell_list[i].x[0];
+    }
+    domain.balance(x);
+    migrateCells();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::distribute() {
+    /*
+     * splits a cell list that every rank placed or loaded in full over the slabs, starting from rank 0's copy
+     * rank 0 keeps the loaded generator for recruitment, the others continue with streams of their own
+     */
+    if(!domain.distributed()){return;}
+    if(domain.rank() != 0){
+        cell_list.clear();
+        mt.seed(static_cast<unsigned int>(crn::mix(mt() + domain.rank())));
+    }
+    rebalance();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::gatherCells(CellList<Dim> &all) {
+    // every rank's cells on rank 0, for outputs and checkpoints
+    std::vector<int> indices(cell_list.size());
+    for(int i=0; i<cell_list.size(); ++i){
+        indices[i] = i;
+    }
+    std::vector<char> bytes;
+    domain.gather(packCells(indices), bytes);
+    all.clear();
+    unpackCells(bytes, all);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::syncPopulation() {
+    // the live counts of this rank summed over all ranks
+    worldPopulation = population;
+    if(!domain.distributed()){return;}
+    int counts[8];
+    for(int k=0; k<8; ++k){
+        counts[k] = population.n[k/4][k%4];
+    }
+    domain.sum(counts, 8);
+    for(int k=0; k<8; ++k){
+        worldPopulation.n[k/4][k%4] = counts[k];
+    }
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
@@ -0,0 +1,97 @@
+#include "Environment.h"
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::printStep(double time) {
+    if(!options.verbose){return;}
+
+    int numT8 = worldPopulation.of(1, 1);
+    int numT8s = worldPopulation.of(1, 2);
+    int numC = worldPopulation.total(0);
+
+    std::cout << "************************************\n"
+              << "Time (d): " << time/24 << std::endl
+              << "Cancer: " << numC << std::endl
+              << "CD8: " << numT8 << " " << numT8s << std::endl;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::printMode() {
+    if(!options.verbose){return;}
+    std::cout << "Mode: " << (parallel ? "parallel" : "serial")
+              << " (cells: " << cell_list.size() << ", threshold: " << options.parallelThreshold << ")";
+    if(domain.distributed()){
+        std::cout << " on rank 0 of " << domain.size();
+    }
+    if(!core.empty()){
+        std::cout << " core: " << core.cells() << " cells in " << core.numHeld << " bins";
+    }
+    std::cout << std::endl;
+}
+
+template<int Dim, class Model>
+const PopulationCounts &Environment<Dim, Model>::populationCounts() const {
+    return worldPopulation;
+}
+
+template<int Dim, class Model>
+int Environment<Dim, Model>::numCells(int type) const {
+    if(type != 0 && type != 1){return 0;}
+    return worldPopulation.total(type);
+}
+
+template<int Dim, class Model>
+int Environment<Dim, Model>::numCells(int type, int state) const {
+    if((type != 0 && type != 1) || state < -1 || state > 2){return 0;}
+    return worldPopulation.of(type, state);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::recount() {
+    // full count, after the cell list is replaced (new tumor, checkpoint, copy); afterwards counts are kept live
+    population = PopulationCounts();
+    for(auto &cell : cell_list){
+        population.add(cell.type, cell.state);
+    }
+    for(auto &bin : core.bins){
+        population.add(0, 0, bin.alive);
+        population.add(0, -1, bin.dead);
+    }
+    syncPopulation();
+}
+
+template<int Dim, class Model>
+double Environment<Dim, Model>::day() const {
+    return steps*stepSize/24;
+}
+
+template<int Dim, class Model>
+double Environment<Dim, Model>::getTumorRadius() const {
+    return tumorRadius;
+}
+
+template<int Dim, class Model>
+std::string Environment<Dim, Model>::getStopReason() const {
+    return stopReason;
+}
+
+template<int Dim, class Model>
+std::array<double, 3> Environment<Dim, Model>::getTumorCenter() const {
+    std::array<double, 3> center = {0, 0, 0};
+    std::copy(tumorCenter.begin(), tumorCenter.end(), center.begin());
+    return center;
+}
+
+template<int Dim, class Model>
+const CellList<Dim> &Environment<Dim, Model>::cells() const {
+    return cell_list;
+}
+
+template<int Dim, class Model>
+const std::vector<std::array<double, 5>> &Environment<Dim, Model>::getDailyOutputs() const {
+    return dailyOutputs;
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
@@ -0,0 +1,194 @@
+#include "Environment.h"
+#include "DiscreteImg.h"
+
+std::shared_ptr<Parameters> Parameters::read(std::string paramDir) {
+    auto params = std::make_shared<Parameters>();
+
+    std::ifstream dataCP(paramDir+"/cellParams.csv");
+    std::string line;
+    while(std::getline(dataCP, line)){
+        std::stringstream lineStream(line);
+        std::string cell;
+        std::vector<double> parsedRow;
+        while(std::getline(lineStream, cell, ',')){
+            parsedRow.push_back(std::stod(cell));
+        }
+        params->cellParams.push_back(parsedRow);
+    }
+    dataCP.close();
+
+    std::ifstream dataRP(paramDir+"/recParams.csv");
+    while(std::getline(dataRP, line)){
+        std::stringstream lineStream(line);
+        std::string cell;
+        std::vector<double> parsedRow;
+        while(std::getline(lineStream, cell, ',')){
+            parsedRow.push_back(std::stod(cell));
+        }
+        params->recParams.push_back(parsedRow[0]);
+    }
+    dataRP.close();
+
+    std::ifstream dataEP(paramDir+"/envParams.csv");
+    while(std::getline(dataEP, line)){
+        std::stringstream lineStream(line);
+        std::string cell;
+        std::vector<double> parsedRow;
+        while(std::getline(lineStream, cell, ',')){
+            parsedRow.push_back(std::stod(cell));
+        }
+        params->envParams.push_back(parsedRow[0]);
+    }
+    dataEP.close();
+
+    if(params->cellParams.empty() || params->recParams.empty() || params->envParams.empty()){
+        throw std::runtime_error("Parameters::read -> missing parameter files in "+paramDir);
+    }
+
+    return params;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::save(double tstep) {
+    // with several ranks rank 0 writes the cells of all of them, cells held in the hybrid core are laid out in their bins
+    CellList<Dim> gathered;
+    if(domain.distributed()){
+        gatherCells(gathered);
+        if(domain.rank() != 0){return;}
+    } else if(!core.empty()){
+        gathered = cell_list;
+        heldCells(gathered);
+    }
+    const CellList<Dim> &cells = domain.distributed() || !core.empty() ? gathered : cell_list;
+
+    std::ofstream myfile;
+
+    int numCancer = worldPopulation.total(0) - worldPopulation.of(0, -1);
+    int c8 = worldPopulation.total(1);
+
+    double time = steps*tstep/24;
+    myfile.open(saveDir+"/outputs.csv");
+    myfile << time << "," << numCancer << "," << c8
+           << "," << tumorCenter[0] << "," << tumorCenter[1] << "," << zOf(tumorCenter) << "," << tumorRadius << std::endl;
+    myfile.close();
+
+    Model::saveCells(saveDir, cells);
+
+    myfile.open(saveDir+"/edgeCells.csv");
+    for(int i=0; i<edgeCells.size(); ++i){
+        myfile << edgeCells[i][0];
+        for(int j=1; j<edgeCells[i].size(); ++j){
+            myfile << "," << edgeCells[i][j];
+        }
+        myfile << std::endl;
+    }
+    myfile.close();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::saveTermination() {
+    // why and when the simulation ended
+    if(domain.rank() != 0){return;}
+    std::ofstream myfile;
+    myfile.open(saveDir+"/termination.csv");
+    myfile << day() << "," << stopReason << std::endl;
+    myfile.close();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::saveThreadBalance() {
+    /*
+     * busy (CPU) seconds of every thread in the loops over contacts, and per loop the slowest thread over the mean
+     * 1 is balanced, above it the other threads wait at the loop's barrier for the difference
+     */
+    if(!options.threadTiming || threadBusy.empty() || domain.rank() != 0){return;}
+    const char *names[numPhases] = {"contacts", "sweep", "forces", "overlap"};
+
+    std::ofstream myfile;
+    myfile.open(saveDir+"/threadBalance.csv");
+    myfile << "phase,thread,busy" << std::endl;
+    std::cout << "Thread balance (slowest/mean busy time):";
+    for(int p=0; p<numPhases; ++p){
+        double slowest = 0;
+        double total = 0;
+        for(int t=0; t<threadBusy.size(); ++t){
+            myfile << names[p] << "," << t << "," << threadBusy[t][p] << std::endl;
+            slowest = std::max(slowest, threadBusy[t][p]);
+            total += threadBusy[t][p];
+        }
+        std::cout << " " << names[p] << " " << (total > 0 ? slowest*threadBusy.size()/total : 1.0);
+    }
+    std::cout << std::endl;
+    myfile.close();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::saveImage() {
+    /*
+     * rasterizes the current cells without going through the csv files
+     * layers follow parseData.loadSingle: cancer, active CD8, suppressed CD8, PD-L1 (scaled to a max of 1)
+     * the image is bound to the cancer layer
+     */
+    CellList<Dim> gathered;
+    if(domain.distributed()){
+        gatherCells(gathered);
+        if(domain.rank() != 0){return;}
+    } else if(!core.empty()){
+        gathered = cell_list;
+        heldCells(gathered);
+    }
+    const CellList<Dim> &cells = domain.distributed() || !core.empty() ? gathered : cell_list;
+    std::vector<std::vector<std::array<double, 3>>> layers(4);
+
+    double maxPDL1 = 0;
+    for(auto &cell : cells){
+        if(cell.type == 0){
+            maxPDL1 = std::max(maxPDL1, cell.pdl1);
+        }
+    }
+
+    for(auto &cell : cells){
+        if(cell.type == 0){
+            layers[0].push_back({cell.x[0], cell.x[1], 1});
+            layers[3].push_back({cell.x[0], cell.x[1], maxPDL1 > 0 ? cell.pdl1/maxPDL1 : 0});
+        } else if(cell.type == 1 && cell.state == 1){
+            layers[1].push_back({cell.x[0], cell.x[1], 1});
+        } else if(cell.type == 1 && cell.state == 2){
+            layers[2].push_back({cell.x[0], cell.x[1], 1});
+        }
+    }
+    if(layers[0].empty()){
+        // nothing to bind the image to, the python pipeline skips these runs as well
+        // a batch slot is still filled (with zeros, flagged 2) so readers are not left waiting
+        if(!options.imageBatch.empty() && options.imageSize > 0){
+            std::vector<size_t> shape = {static_cast<size_t>(options.imageSize), static_cast<size_t>(options.imageSize), layers.size()};
+            std::vector<double> empty(shape[0]*shape[1]*shape[2], 0.0);
+            DiscreteImg::saveNpySlot(options.imageBatch, options.imageSlot, options.imageSlots, empty, shape, 2);
+        }
+        return;
+    }
+
+    DiscreteImg img(options.imageGridSize, layers, 0);
+    std::vector<size_t> shape;
+    std::vector<double> grid = img.smallGrids(options.imageSize, shape);
+    if(options.imageBatch.empty()){
+        DiscreteImg::saveNpy(saveDir+"/image.npy", grid, shape);
+    } else{
+        DiscreteImg::saveNpySlot(options.imageBatch, options.imageSlot, options.imageSlots, grid, shape, 1);
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::recordDay() {
+    // daily summary kept in memory for replicate statistics
+    dailyOutputs.push_back({day(),
+                            static_cast<double>(numCells(0)),
+                            static_cast<double>(numCells(1, 1)),
+                            static_cast<double>(numCells(1, 2)),
+                            tumorRadius});
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
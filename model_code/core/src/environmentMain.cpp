@@ -0,0 +1,320 @@
+#include "Environment.h"
+
+template<int Dim, class Model>
+Environment<Dim, Model>::Environment(std::string saveFld, RunOptions opts):
+        Environment(saveFld, Parameters::load<Model>(saveFld+"/params"), opts) {}
+
+template<int Dim, class Model>
+Environment<Dim, Model>::Environment(std::string saveFld, std::shared_ptr<const Parameters> parameters, RunOptions opts):
+        params(parameters), cellParams(params->cellParams), recParams(params->recParams), envParams(params->envParams),
+        mt((std::random_device())()) {
+    /*
+     * initialize a simulation environment
+     * -----------------------------------
+     * uses the three parameter sets (loaded from saveFld/params unless given)
+     *  cell parameters
+     *  environment parameters
+     *  recruitment parameters
+     *
+     * set environment variables to their respective values
+     */
+
+    saveDir = saveFld;
+    options = opts;
+    // with several ranks rank 0 reports progress for all of them
+    if(domain.rank() != 0){
+        options.verbose = false;
+    }
+    parallel = false;
+    initialized = false;
+    stepSize = 0;
+    timerStep = -1;
+
+    cd8RecRate = recParams[0];
+    cd8Ratio = recParams[1];
+    recDist = recParams[2];
+
+    if((envParams[1] == 1) != (Dim == 3)){
+        throw std::runtime_error("Environment::Environment -> envParams dimension does not match the environment");
+    }
+    simulationDuration = envParams[0];
+
+    tumorCenter.fill(0);
+    tumorRadius = 0;
+
+    steps = 0;
+
+    if(options.fidelity < 0 || options.fidelity > 5){
+        throw std::runtime_error("Environment::Environment -> fidelity level must be between 0 and 5");
+    }
+    fidelityScale = 1 << options.fidelity;
+    if(options.edgeInterval < 1){
+        throw std::runtime_error("Environment::Environment -> edgeInterval must be at least one day");
+    }
+    neighborsValid = false;
+    numOwned = 0;
+
+    if(options.coreDepth < 0){
+        throw std::runtime_error("Environment::Environment -> coreDepth must not be negative");
+    }
+    if(options.coreDepth > 0 && domain.distributed()){
+        throw std::runtime_error("Environment::Environment -> the hybrid core runs on a single rank");
+    }
+
+    // ghosts reach as far as neighbors, and with influences 3 influence radii, see environmentDomain.cpp
+    haloWidth = 0;
+    for(const CellTypeParams &p : params->cellTypes){
+        haloWidth = std::max(haloWidth, 10*p.rmax);
+        if(Model::influence){
+            haloWidth = std::max(haloWidth, 3*p.influenceRadius);
+        }
+    }
+
+    dt = 0.005*fidelityScale;
+    cd82rec = 0;
+
+    if(options.commonRandomNumbers){
+        mt.seed(static_cast<unsigned int>(crn::mix(options.crnSeed)));
+    }
+}
+
+template<int Dim, class Model>
+Cell<Dim> Environment<Dim, Model>::newCell(Vec loc, std::string cellType, double time, uint64_t lineage) {
+    /*
+     * cell at the end of cell_list with its own random stream
+     * with common random numbers the stream is derived from the lineage instead of the environment's generator
+     */
+    int type;
+    if(cellType == "cancer"){
+        type = 0;
+    } else if(cellType == "CD8"){
+        type = 1;
+    } else{
+        throw std::runtime_error("Environment::newCell -> unavailable cell type "+cellType);
+    }
+
+    uint64_t seed;
+    if(options.commonRandomNumbers){
+        seed = crn::key(options.crnSeed, lineage, crn::stream, 0);
+    } else{
+        seed = mt();
+    }
+    Cell<Dim> cell(loc, static_cast<int>(cell_list.size()), &params->cellTypes[type], time, seed);
+    cell.lineage = lineage;
+    cell.currentStep = steps;
+    if(options.commonRandomNumbers){
+        cell.useCommonRandomNumbers(options.crnSeed);
+    }
+    cell.useEventTimers(options.eventTimers);
+    return cell;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::initializeTumor() {
+    /*
+     * place initial tumor as rings of cancer cells around the origin
+     * with several ranks rank 0 places it and the cells are then split over the slabs
+     */
+    if(domain.rank() != 0){
+        distribute();
+        recount();
+        tumorSize();
+        return;
+    }
+
+    //cell_list.push_back(Cell({0,0,0}, 0, cellParams, "cancer", threeD));
+    int radiiCells = Model::initialRings(envParams);
+    double diameter = 2*params->cellTypes[0].radius;
+    Vec loc;
+    loc.fill(0);
+    cell_list.push_back(newCell(loc, "cancer", 0.0, 0));
+    int q = 1;
+    for(int i=1; i<radiiCells; ++i){
+        double circumfrence = 2*i*diameter*3.1415;
+        double nCells = circumfrence/diameter;
+        for(int j=0; j<nCells; ++j){
+            loc[0] = i*diameter*cos(2*3.1415*j/nCells);
+            loc[1] = i*diameter*sin(2*3.1415*j/nCells);
+            cell_list.push_back(newCell(loc, "cancer", 0.0, q));
+            q++;
+        }
+    }
+
+    // CD8 placed uniformly within recDist outside the initial tumor, for models that start with them
+    int nTcells = static_cast<int>(Model::initialCD8Fraction*cell_list.size());
+    double radius = static_cast<double>(radiiCells)*diameter;
+    std::uniform_real_distribution<double> angle(0.0,2*3.1415);
+    std::uniform_real_distribution<double> distance(0.0, recDist);
+    for(int i=0; i<nTcells; ++i){
+        double ang, dist;
+        if(options.commonRandomNumbers){
+            ang = 2*3.1415*crn::uniform(crn::key(options.crnSeed, q, crn::initialPlacement, 0, 0));
+            dist = recDist*crn::uniform(crn::key(options.crnSeed, q, crn::initialPlacement, 0, 1));
+        } else{
+            ang = angle(mt);
+            dist = distance(mt);
+        }
+        loc[0] = (radius + dist)*cos(ang);
+        loc[1] = (radius + dist)*sin(ang);
+        cell_list.push_back(newCell(loc, "CD8", 0.0, q));
+        q++;
+    }
+
+    distribute();
+    recount();
+    tumorSize();
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::bindCellTypes() {
+    // point every cell at this run's type parameters and event sampling, after loading or copying cells
+    for(auto &cell : cell_list){
+        cell.typeParams = &params->cellTypes[cell.type];
+        cell.useEventTimers(options.eventTimers);
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::initialize(double tstep) {
+    /*
+     * place the initial tumor, or take it from the burn-in cache
+     */
+    tstep = effectiveStep(tstep);
+    stepSize = tstep;
+    if(options.burnInCache.empty()){
+        initializeTumor();
+    } else{
+        startFromBurnIn(tstep);
+    }
+    initialized = true;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::startFrom(const EnvironmentBase &base) {
+    /*
+     * copies the state of another environment with the same parameters, e.g. a shared initial tumor
+     * random streams are reseeded so the copies evolve independently
+     */
+    auto *other = dynamic_cast<const Environment<Dim, Model>*>(&base);
+    if(!other){
+        throw std::runtime_error("Environment::startFrom -> source has a different dimension");
+    }
+    const Environment<Dim, Model> &source = *other;
+    cell_list = source.cell_list;
+    bindCellTypes();
+    core = source.core;
+    edgeCells = source.edgeCells;
+    steps = source.steps;
+    cd82rec = source.cd82rec;
+    timerStep = source.timerStep;
+    tumorRadius = source.tumorRadius;
+    tumorCenter = source.tumorCenter;
+    neighborsValid = false;
+    recount();
+    reseed();
+    initialized = true;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::simulate(double tstep) {
+    /*
+     * initializes and runs a simulation
+     * ---------------------------------
+     * place initial tumor, unless continuing from a checkpoint
+     *  with a burn-in cache, the tumor is taken from (or grown into) the cache
+     * run simulation loop
+     *  recruit immune cells
+     *  run cell functions
+     * ends once time limit is reached, there are no more cancer cells, or a stopping criterion is met
+     */
+
+    if(!initialized){
+        initialize(tstep);
+    }
+    tstep = effectiveStep(tstep);
+    stepSize = tstep;
+
+    if(options.verbose){
+        std::cout << "starting simulation...\n";
+    }
+    while(tstep*steps/24 < simulationDuration) {
+        if(!runStep(tstep)){
+            break;
+        }
+    }
+    tumorSize();
+    save(tstep);
+    if(options.imageGridSize > 0){
+        saveImage();
+    }
+
+    if(stopReason.empty()){
+        stopReason = "completed";
+    }
+    saveTermination();
+    saveThreadBalance();
+}
+
+template<int Dim, class Model>
+double Environment<Dim, Model>::effectiveStep(double tstep) {
+    // outer step at the run's fidelity, days have to stay a whole number of steps
+    double scaled = tstep*fidelityScale;
+    if(fmod(24, scaled) != 0){
+        throw std::runtime_error("Environment::effectiveStep -> a day is not a whole number of steps at this fidelity");
+    }
+    return scaled;
+}
+
+template<int Dim, class Model>
+bool Environment<Dim, Model>::runStep(double tstep) {
+    /*
+     * one step of the simulation loop
+     * returns false once there are no cancer cells left or a stopping criterion is met
+     */
+    recruitImmuneCells(tstep);
+    runCells(tstep);
+
+    // exact center and radius every simulation day, edge cells every edgeInterval*fidelityScale days
+    // with dailyTumorCenter at the start of the day as before, otherwise at its end, so the saved values are exact
+    int edgeDays = options.edgeInterval*fidelityScale;
+    if (options.dailyTumorCenter && fmod(steps * tstep, 24) == 0) {
+        int day = static_cast<int>(steps * tstep / 24);
+        tumorSize(day % edgeDays == 0 || edgeCells.empty());
+        placeCore(tstep);
+    }
+
+    steps += 1;
+    printStep(steps * tstep);
+    if (fmod(steps * tstep, 24) == 0) {
+        if (!options.dailyTumorCenter) {
+            int day = static_cast<int>(steps * tstep / 24);
+            tumorSize(day % edgeDays == 0 || edgeCells.empty());
+            placeCore(tstep);
+        }
+        // save every simulation day
+        save(tstep);
+        recordDay();
+        printMode();
+        // slabs follow the growing tumor
+        rebalance();
+    }
+
+    if (worldPopulation.total(0) == 0) {
+        stopReason = "no cancer cells";
+        return false;
+    }
+
+    if (fmod(steps * tstep, 24) == 0 && checkStoppingCriteria()) {
+        return false;
+    }
+
+    if (options.checkpointInterval > 0 && fmod(steps * tstep, 24*options.checkpointInterval) == 0) {
+        saveCheckpoint(saveDir+"/checkpoint.bin");
+    }
+    return true;
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
@@ -0,0 +1,134 @@
+#include "Environment.h"
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::tumorSize(bool findEdges) {
+   // summed in double, also with float positions, and over all ranks
+   std::array<double, Dim+1> avg;
+   avg.fill(0);
+   for(auto &c : cell_list){
+       if(c.type == 0) {
+           for(int k=0; k<Dim; ++k){
+               avg[k] += c.x[k];
+           }
+           avg[Dim] += 1;
+       }
+   }
+   // cells held in the hybrid core count at their bin's center
+   std::array<double, Dim> held{};
+   core.positionSum(held);
+   for(int k=0; k<Dim; ++k){
+       avg[k] += held[k];
+   }
+   avg[Dim] += core.cells();
+   domain.sum(avg.data(), Dim+1);
+
+   for(int k=0; k<Dim; ++k){
+       avg[k] /= avg[Dim];
+   }
+
+   std::copy(avg.begin(), avg.begin()+Dim, tumorCenter.begin());
+
+   double dist = 0;
+   for(auto & cell : cell_list){
+       if(cell.type == 0){
+           dist = std::max(dist, cell.calcDistance(tumorCenter));
+       }
+   }
+   domain.max(&dist, 1);
+
+   tumorRadius = dist;
+
+   if(!findEdges){return;}
+
+   // owned cancer cells are checked against ghosts as well, the edge cells of all ranks are then joined in rank order
+   exchangeHalo();
+   edgeCells.clear();
+   for(int i=0; i<numOwned; ++i){
+       if(cell_list[i].type != 0){continue;}
+
+       double radius = cell_list[i].radius();
+       Vec x = cell_list[i].x;
+       Vec dx;
+       for(int k=0; k<Dim; ++k){
+           dx[k] = x[k] - tumorCenter[k];
+       }
+       double norm = cell_list[i].calcNorm(dx);
+       if(norm < 0.75*tumorRadius){continue;}
+       Vec nx;
+       for(int k=0; k<Dim; ++k){
+           nx[k] = x[k] + 4*radius*dx[k]/norm;
+       }
+       bool free = true;
+       for(int j=0; j<cell_list.size(); ++j){
+           if(i == j){continue;}
+           if(cell_list[j].type != 0){continue;}
+           if(cell_list[j].calcDistance(nx) < 2*cell_list[j].radius()){
+               free = false;
+               break;
+           }
+       }
+       free = free && core.heldAt(nx) < 0;
+
+       if(free){
+           edgeCells.push_back(x);
+       }
+   }
+   dropHalo();
+
+   if(domain.distributed()){
+       std::vector<char> mine(edgeCells.size()*sizeof(Vec)), all;
+       std::copy(reinterpret_cast<const char*>(edgeCells.data()), reinterpret_cast<const char*>(edgeCells.data())+mine.size(), mine.begin());
+       domain.allGather(mine, all);
+       edgeCells.resize(all.size()/sizeof(Vec));
+       std::copy(all.begin(), all.end(), reinterpret_cast<char*>(edgeCells.data()));
+   }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::moveTumorCenter(const std::array<double, Dim> &cancerSum, double maxDistance) {
+    /*
+     * per-step tumor center from the summed cancer cell positions
+     * maxDistance is the farthest cancer cell from the old center,
+     * so the radius is at most that plus the distance the center moved
+     * tumorSize replaces both with exact values once a day
+     */
+    int numC = worldPopulation.total(0);
+    if(numC == 0){return;}
+    double shift = 0;
+    for(int k=0; k<Dim; ++k){
+        double c = cancerSum[k]/numC;
+        shift += (c - tumorCenter[k])*(c - tumorCenter[k]);
+        tumorCenter[k] = c;
+    }
+    tumorRadius = maxDistance + std::sqrt(shift);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::updateStepProbabilities(double tstep) {
+    /*
+     * division, death, kill, and hypoxic death have a fixed hourly probability per cell type
+     * their probability over one step only changes with the step size, so it is computed here rather than per cell
+     * event timers sampled at another step size are dropped, the waiting times are memoryless so they can be redrawn
+     */
+    if(timerStep != tstep){
+        for(auto &cell : cell_list){
+            cell.resetEventTimers();
+        }
+        timerStep = tstep;
+    }
+    if(stepProbs[0].tstep == tstep){return;}
+    for(int type=0; type<2; ++type){
+        const CellTypeParams &p = params->cellTypes[type];
+        StepProbabilities &step = stepProbs[type];
+        step.tstep = tstep;
+        step.division = Cell<Dim>::probTime(p.divProb, tstep);
+        step.death = Cell<Dim>::probTime(p.deathProb, tstep);
+        step.kill = Cell<Dim>::probTime(p.killProb, tstep);
+        step.hypoxia = Cell<Dim>::probTime(p.hypoxicP, tstep);
+    }
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
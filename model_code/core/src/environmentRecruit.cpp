@@ -0,0 +1,94 @@
+#include "Environment.h"
+
+template<int Dim, class Model>
+double Environment<Dim, Model>::recruitmentIncrement(double tstep) {
+    // recruitment is scaled by number of cancer cells
+
+    int numT8 = worldPopulation.total(1);
+    int numC = worldPopulation.total(0);
+
+    double cd82c = static_cast<double>(numT8)/ static_cast<double>(numC);
+    //double ratio = std::max(0.0, (1 - cd82c/cd8Ratio));
+    return tstep*cd8RecRate*static_cast<double>(numC)*static_cast<double>(cd82c < cd8Ratio);//*ratio;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::recruitImmuneCells(double tstep) {
+    // every rank keeps the same cd82rec, recruits are placed on rank 0 and then sent to the rank owning their position
+    cd82rec += recruitmentIncrement(tstep);
+    uint64_t k = 0;
+    while (cd82rec >= 1) {
+        // the k-th recruit of a step has the same lineage in every run
+        uint64_t lineage = crn::key(0, 0, crn::recruitment, steps, k++);
+        if(domain.rank() == 0){
+            Vec recLoc = recruitImmuneWhole(lineage);
+            cell_list.push_back(newCell(recLoc, "CD8", static_cast<double>(steps)*tstep/24, lineage));
+            population.add(1, cell_list.back().state);
+        }
+        cd82rec -= 1;
+    }
+    if(k > 0){
+        migrateCells();
+        syncPopulation();
+    }
+}
+
+template<int Dim, class Model>
+typename Environment<Dim, Model>::Vec Environment<Dim, Model>::recruitImmuneWhole(uint64_t lineage) {
+    /*
+     * cells enter a distance, d, away from the tumor radius based on an exponential distribution
+     * cells enter d away from a random edgeCell, such that the cell, edgeCell, and tumor center form a straight line
+     */
+
+    int edgeIdx;
+    if(options.commonRandomNumbers){
+        double u = crn::uniform(crn::key(options.crnSeed, lineage, crn::recruitLocation, steps, 0));
+        edgeIdx = std::min(static_cast<int>(u*edgeCells.size()), static_cast<int>(edgeCells.size())-1);
+    } else{
+        std::uniform_int_distribution<int> ec(0, edgeCells.size()-1);
+        edgeIdx = ec(mt);
+    }
+    Vec x = edgeCells[edgeIdx];
+    Vec dx;
+    double norm = 0;
+    for(int k=0; k<Dim; ++k){
+        dx[k] = x[k] - tumorCenter[k];
+        norm += dx[k]*dx[k];
+    }
+    norm = sqrt(norm);
+    double alpha = -log2(0.01);
+    double lambda = alpha*0.693/recDist;
+    double distance;
+    if(options.commonRandomNumbers){
+        double u = crn::uniform(crn::key(options.crnSeed, lineage, crn::recruitLocation, steps, 1));
+        distance = std::max(-log1p(-u)/lambda, recDist);
+    } else{
+        std::exponential_distribution<double> loc(lambda);
+        distance = std::max(loc(mt), recDist);
+    }
+
+    Vec recLoc;
+    bool finite = true;
+    for(int k=0; k<Dim; ++k){
+        recLoc[k] = distance*(dx[k]/norm) + x[k];
+        finite = finite && fabs(recLoc[k]) <= 1e10;
+    }
+
+    if(!finite){
+        for(int k=0; k<Dim; ++k){
+            std::cout << "rl" << k << ": " << recLoc[k] << std::endl
+                      << "edge cell " << k << ": " << x[k] << std::endl;
+        }
+        std::cout << "norm: " << norm << std::endl
+                  << "distance: " << distance << std::endl;
+
+        throw std::runtime_error("recruiting cells");
+    }
+
+    return recLoc;
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
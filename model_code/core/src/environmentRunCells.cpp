@@ -0,0 +1,540 @@
+#include "Environment.h"
+#include <ctime>
+
+static double threadSeconds() {
+    // CPU time of the calling thread, unlike wall time it leaves out time the thread was descheduled
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+template<int Dim, class Model>
+template<class Work>
+void Environment<Dim, Model>::balanceChunks(std::vector<int> &chunks, Work work) {
+    /*
+     * one contiguous range of cells per thread, chunks[t] to chunks[t+1]
+     * cells in the dense core have many more contacts than CD8 in the stroma, and some loops only work on one type,
+     * so ranges of equal cell counts leave threads idle at the barrier
+     * instead the ranges are cut at equal shares of the prefix sum of work(i) + 1
+     * every cell is still handled by one thread in the same way, so results do not depend on the split
+     */
+    int numThreads = parallel ? omp_get_max_threads() : 1;
+    int n = numOwned;
+    chunks.assign(numThreads+1, n);
+    chunks[0] = 0;
+    if(options.staticChunks || numThreads == 1){
+        for(int t=1; t<numThreads; ++t){
+            chunks[t] = static_cast<int>(static_cast<long long>(n)*t/numThreads);
+        }
+        return;
+    }
+
+    chunkWork.resize(n+1);
+    chunkWork[0] = 0;
+    for(int i=0; i<n; ++i){
+        chunkWork[i+1] = chunkWork[i] + work(i) + 1;
+    }
+    int t = 1;
+    for(int i=0; i<n && t<numThreads; ++i){
+        while(t < numThreads && chunkWork[i+1]*numThreads >= chunkWork[n]*t){
+            chunks[t++] = i+1;
+        }
+    }
+}
+
+template<int Dim, class Model>
+template<class Body>
+void Environment<Dim, Model>::forChunks(const std::vector<int> &chunks, int phase, Body body) {
+    // runs body(i) over each thread's range, a team smaller than planned takes the ranges round-robin
+    int numChunks = static_cast<int>(chunks.size())-1;
+    if(options.threadTiming && threadBusy.size() < numChunks){
+        threadBusy.resize(numChunks, std::array<double, numPhases>{});
+    }
+#pragma omp parallel if(parallel)
+    {
+        double start = options.threadTiming ? threadSeconds() : 0;
+        int t = omp_get_thread_num();
+        for(int b=t; b<numChunks; b+=omp_get_num_threads()){
+            for(int i=chunks[b]; i<chunks[b+1]; ++i){
+                body(i);
+            }
+        }
+        if(options.threadTiming && t < threadBusy.size()){
+            threadBusy[t][phase] += threadSeconds() - start;
+        }
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::neighborInfluenceInteractions(double tstep) {
+
+    /*
+     * NEIGHBORS
+     * - determine neighbors
+     * - determine influences on a cell
+     *
+     * CANCER CELLS
+     * - inhibition probability from the PD-L1 they start the step with
+     * - gain PD-L1
+     *
+     * CONTACTS, one sweep over the CD8 using the contact lists, each CD8 - cancer contact visited once
+     * - inhibit CD8, a suppressed CD8 kills nothing this step
+     * - CD8 kill cancer cell
+     * a CD8 writes only its own state, its kills are collected and applied once it is known to stay active
+     * several CD8 can kill the same cancer cell, the atomic swap on its state lets exactly one of them count the death
+     */
+
+    // below full fidelity, neighbors and influences are kept for fidelityScale steps
+    // with several ranks the ghosts change every step, so the lists do too
+    if(!neighborsValid || steps % fidelityScale == 0){
+        buildNeighbors();
+        neighborsValid = fidelityScale > 1 && !domain.distributed();
+    }
+    buildContacts();
+
+    // one inhibition probability per cancer cell, rather than one per CD8 contact, ghosts included
+    if(Model::inhibition){
+        inhibitionProbs.resize(cell_list.size());
+    }
+#pragma omp parallel for if(parallel)
+    for(int i=0; i<cell_list.size(); ++i){
+        if(cell_list[i].type == 0){
+            if(Model::inhibition){
+                inhibitionProbs[i] = Model::inhibitionProbability(cell_list[i], tstep);
+            }
+            if(i < numOwned){
+                Model::influenceResponse(cell_list[i], tstep);
+            }
+        }
+    }
+
+    int numThreads = parallel ? omp_get_max_threads() : 1;
+    if(threadTargets.size() < numThreads){
+        threadTargets.resize(numThreads);
+    }
+    // only active CD8 kill, so the kill probability is the type's
+    double pKill = stepProbs[1].kill;
+    int suppressed = 0;
+    int killed = 0;
+
+    balanceChunks(sweepChunks, [&](int i){
+        return cell_list[i].type == 1 && cell_list[i].state == 1 ? contactCounts[i] : 0;
+    });
+    forChunks(sweepChunks, sweepPhase, [&](int i){
+        Cell<Dim> &cd8 = cell_list[i];
+        if(cd8.type != 1 || cd8.state != 1){return;}
+
+        std::vector<int> &targets = threadTargets[omp_get_thread_num()];
+        targets.clear();
+        int start = cd8.neighborStart;
+        for(int k=start; k<start+contactCounts[i]; ++k){
+            int c = contactIndices[k];
+            const Cell<Dim> &cancer = cell_list[c];
+            // distances are from this step's build, cells have not moved since
+            if(cancer.type != 0 || contactDistances[k] > cd8.radius()+cancer.radius()){continue;}
+            if(Model::inhibition){
+                Model::inhibit(cd8, cancer, inhibitionProbs[c]);
+                if(cd8.state == 2){
+                    targets.clear();
+#pragma omp atomic
+                    suppressed++;
+                    break;
+                }
+            }
+            if(cd8.kills(pKill, cancer.lineage)){
+                targets.push_back(c);
+            }
+        }
+
+        for(int c : targets){
+            int previous;
+#pragma omp atomic capture
+            {previous = cell_list[c].state; cell_list[c].state = -1;}
+            if(previous != -1 && c >= numOwned){
+#pragma omp critical
+                ghostKills.push_back(c);
+            } else if(previous != -1){
+#pragma omp atomic
+                killed++;
+            }
+        }
+    });
+    killed += applyGhostKills();
+    population.move(1, 1, 2, suppressed);
+    population.move(0, 0, -1, killed);
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::buildNeighbors() {
+    /*
+     * neighbor lists and influences
+     * each thread takes a contiguous block of cells and appends their neighbors to its own buffer
+     * the buffers are then joined in thread order, so the result is the same for any thread count
+     * all buffers keep their capacity between steps
+     */
+    int numThreads = parallel ? omp_get_max_threads() : 1;
+    if(threadNeighbors.size() < numThreads){
+        threadNeighbors.resize(numThreads);
+    }
+    // a team smaller than requested leaves some buffers unused, they must not hold the last step's lists
+    for(auto &buffer : threadNeighbors){
+        buffer.clear();
+    }
+    std::vector<size_t> blockStart(numThreads+1, 0);
+
+#pragma omp parallel if(parallel)
+    {
+        int t = omp_get_thread_num();
+        std::vector<int> &buffer = threadNeighbors[t];
+#pragma omp for schedule(static)
+        for(int i=0; i<numOwned; ++i){
+            cell_list[i].neighborStart = static_cast<int>(buffer.size());
+            if(Model::influence){
+                cell_list[i].clearInfluence();
+            }
+            for(auto &c : cell_list){
+                // assume that a cell cannot influence itself
+                if(cell_list[i].id != c.id){
+                    if(cell_list[i].isNeighbor(c.x)){
+                        buffer.push_back(c.id);
+                    }
+                    Model::addInfluence(cell_list[i], c);
+                }
+            }
+            cell_list[i].neighborCount = static_cast<int>(buffer.size()) - cell_list[i].neighborStart;
+        }
+        blockStart[t+1] = buffer.size();
+
+#pragma omp barrier
+#pragma omp single
+        for(int k=0; k<numThreads; ++k){
+            blockStart[k+1] += blockStart[k];
+        }
+        // the single above ends with a barrier
+
+#pragma omp for schedule(static)
+        for(int i=0; i<numOwned; ++i){
+            cell_list[i].neighborStart += static_cast<int>(blockStart[t]);
+        }
+    }
+
+    // each thread copies its own block, roughly the part of the buffer the allocator placed on its node
+    neighborIndices.resize(blockStart[numThreads]);
+#pragma omp parallel for schedule(static, 1) if(parallel)
+    for(int t=0; t<numThreads; ++t){
+        std::copy(threadNeighbors[t].begin(), threadNeighbors[t].end(), neighborIndices.begin()+blockStart[t]);
+    }
+}
+
+template<int Dim, class Model>
+NeighborSpan Environment<Dim, Model>::neighborsOf(int i) const {
+    const int *first = neighborIndices.data()+cell_list[i].neighborStart;
+    return {first, first+cell_list[i].neighborCount};
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::buildContacts() {
+    /*
+     * contact lists
+     * -------------
+     * neighbor lists reach 10*rmax, forces only act within rmax and the biology needs touching cells
+     * so once per step the neighbors within reach of either, plus contactSkin, are copied out with their distances
+     * the CD8 sweep, every mechanical sub-step, and the overlap pass then walk these short lists
+     * cells keep their neighbor order, so sums over them are the same as over the full lists
+     * the lists stay exact while no cell has moved more than contactSkin/2 since the build, see contactsStale
+     */
+    double maxRadius = std::max(params->cellTypes[0].radius, params->cellTypes[1].radius);
+    double minRadius = std::min(params->cellTypes[0].radius, params->cellTypes[1].radius);
+    contactSkin = minRadius;
+    for(int type=0; type<2; ++type){
+        const CellTypeParams &p = params->cellTypes[type];
+        contactRange[type] = std::max(p.rmax, p.radius+maxRadius) + contactSkin;
+    }
+
+    contactIndices.resize(neighborIndices.size());
+    contactDistances.resize(neighborIndices.size());
+    contactCounts.resize(cell_list.size());
+    contactX.resize(cell_list.size());
+
+    balanceChunks(contactChunks, [&](int i){return cell_list[i].neighborCount;});
+    forChunks(contactChunks, contactPhase, [&](int i){
+        Cell<Dim> &cell = cell_list[i];
+        double range = contactRange[cell.type];
+        int k = cell.neighborStart;
+        for(int c : neighborsOf(i)){
+            real distance = cell.calcDistance(cell_list[c].x);
+            if(distance < range){
+                contactIndices[k] = c;
+                contactDistances[k] = distance;
+                k++;
+            }
+        }
+        contactCounts[i] = k - cell.neighborStart;
+        contactX[i] = cell.x;
+    });
+    // ghosts have no lists here, but their moves count towards contactsStale
+    for(int i=numOwned; i<cell_list.size(); ++i){
+        contactX[i] = cell_list[i].x;
+    }
+    balanceChunks(forceChunks, [&](int i){return contactCounts[i];});
+}
+
+template<int Dim, class Model>
+bool Environment<Dim, Model>::contactsStale() {
+    // two cells that each moved less than contactSkin/2 cannot have come into range from outside the lists
+    double maxShift = 0;
+#pragma omp parallel for if(parallel) reduction(max:maxShift)
+    for(int i=0; i<cell_list.size(); ++i){
+        maxShift = std::max(maxShift, cell_list[i].calcDistance(contactX[i]));
+    }
+    // a small margin for rounding in the distances
+    return 2*maxShift >= 0.99*contactSkin;
+}
+
+template<int Dim, class Model>
+NeighborSpan Environment<Dim, Model>::contactsOf(int i) const {
+    const int *first = contactIndices.data()+cell_list[i].neighborStart;
+    return {first, first+contactCounts[i]};
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::calculateForces(double tstep) {
+    /*
+     * 1. Calculate total force vector for each cell
+     * 2. Resolve forces on each cell
+     * 3. Determine current overlap for each cell
+     * 4. Determine if each cell is compressed
+     */
+
+    // divide tstep into smaller steps for solving
+    // only solve forces between neighboring cells to improve computation time
+    int Nsteps = static_cast<int>(tstep/dt);
+
+    // iterate thru Nsteps, calculating and resolving forces between neighbors
+    // also includes migration
+    for(int q=0; q<Nsteps; ++q){
+        // migrate first
+#pragma omp parallel for if(parallel)
+        for(int i=0; i<numOwned; ++i){
+            cell_list[i].migrate(dt, edgeCells, tumorCenter);
+        }
+        updateHalo();
+        if(contactsStale()){
+            buildContacts();
+        }
+
+        // calc forces
+        forChunks(forceChunks, forcePhase, [&](int i){
+            for(int c : contactsOf(i)){
+                cell_list[i].calculateForces(cell_list[c].x, cell_list[c].radius(), cell_list[c].type);
+            }
+            if(!core.empty()){
+                coreWall(cell_list[i], false);
+            }
+        });
+
+        // resolve forces
+#pragma omp parallel for if(parallel)
+        for(int i=0; i<numOwned; ++i){
+            cell_list[i].resolveForces(dt);
+        }
+    }
+
+    // calculate overlap for cancer cells and CD8
+    updateHalo();
+    if(contactsStale()){
+        buildContacts();
+    }
+    balanceChunks(overlapChunks, [&](int i){return cell_list[i].type == 0 ? contactCounts[i] : 0;});
+    forChunks(overlapChunks, overlapPhase, [&](int i){
+        if(cell_list[i].type == 0 || cell_list[i].type == 3){
+            for(int c : contactsOf(i)){
+                if(cell_list[c].type == 0){
+                    cell_list[i].calculateOverlap(cell_list[c].x, cell_list[c].radius());
+                }
+                if(cell_list[c].type == 3 && cell_list[i].type == 3){
+                    cell_list[i].calculateOverlap(cell_list[c].x, cell_list[c].radius());
+                }
+            }
+            if(cell_list[i].type == 0 && !core.empty()){
+                coreWall(cell_list[i], true);
+            }
+            cell_list[i].isCompressed();
+            cell_list[i].prolifState();
+        }
+    });
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::internalCellFunctions(double tstep) {
+    /*
+     * cell death via aging
+     * cell proliferation
+     * remove cell if out of bounds
+     */
+    int numCells = cell_list.size();
+    for(int i=0; i<numCells; ++i){
+        const StepProbabilities &step = stepProbs[cell_list[i].type];
+        int state = cell_list[i].state;
+        cell_list[i].age(step.death);
+        if(cell_list[i].type == 0){
+            Model::cancerDeath(cell_list[i], tumorCenter, step);
+        }
+        if(cell_list[i].state != state){
+            population.move(cell_list[i].type, state, cell_list[i].state);
+        }
+
+        if(cell_list[i].type == 0){
+            std::array<double, Dim+1> newLoc = cell_list[i].proliferate(step.division);
+            if(newLoc[Dim] == 1){
+                Vec loc;
+                std::copy(newLoc.begin(), newLoc.begin()+Dim, loc.begin());
+                cell_list.push_back(newCell(loc, "cancer", static_cast<double>(steps)*tstep/24,
+                                            crn::key(0, cell_list[i].lineage, crn::daughter, steps)));
+                cell_list[cell_list.size() - 1].inherit(cell_list[i].pdl1);
+                population.add(0, cell_list.back().state);
+                inheritNeighbors(i);
+            }
+        }
+        if(cell_list[i].type == 1){
+            std::array<double, Dim+1> newLoc = cell_list[i].proliferate(step.division);
+            if(newLoc[Dim] == 1){
+                Vec loc;
+                std::copy(newLoc.begin(), newLoc.begin()+Dim, loc.begin());
+                cell_list.push_back(newCell(loc, "CD8", static_cast<double>(steps)*tstep/24,
+                                            crn::key(0, cell_list[i].lineage, crn::daughter, steps)));
+                population.add(1, cell_list.back().state);
+                inheritNeighbors(i);
+            }
+        }
+    }
+
+    stepCore(tstep);
+
+    // remove dead cells, and cells outside the domain cut-off
+    // cancer cells pushed into a held bin join the core (environmentCore.cpp)
+    // the same pass sums the kept cancer cells' positions for the per-step tumor center
+    // it runs serially in cell order, so the center does not depend on the thread count
+    int totalCells = cell_list.size();
+    // recruits arrive recDist beyond an edge cell and rarely more than twice that, CD8 there are never cut
+    double cutoff[2] = {tumorRadius + options.domainCutoff, tumorRadius + std::max(options.domainCutoff, 2*recDist)};
+    std::array<double, Dim> cancerSum;
+    cancerSum.fill(0);
+    double maxDistance2 = 0;
+    // kept cells are copied into spareCells, which keeps its pages between steps, and the lists are swapped
+    spareCells.clear();
+    for(auto & cell : cell_list){
+        if((Model::removeDeadCells && cell.state == -1) ||
+           (options.domainCutoff > 0 && cell.calcDistance(tumorCenter) > cutoff[cell.type])){
+            population.add(cell.type, cell.state, -1);
+            continue;
+        }
+        if(cell.type == 0 && !core.empty()){
+            int b = core.heldAt(cell.x);
+            if(b >= 0){
+                core.absorb(b, cell);
+                continue;
+            }
+        }
+        if(cell.type == 0){
+            double distance2 = 0;
+            for(int k=0; k<Dim; ++k){
+                cancerSum[k] += cell.x[k];
+                distance2 += (cell.x[k] - tumorCenter[k])*(cell.x[k] - tumorCenter[k]);
+            }
+            maxDistance2 = std::max(maxDistance2, distance2);
+        }
+        spareCells.push_back(cell);
+    }
+    cell_list.swap(spareCells);
+    core.positionSum(cancerSum);
+    domain.sum(cancerSum.data(), Dim);
+    domain.max(&maxDistance2, 1);
+    syncPopulation();
+    if(!options.dailyTumorCenter){
+        moveTumorCenter(cancerSum, std::sqrt(maxDistance2));
+    }
+    migrateCells();
+
+    // shuffle cell list
+    std::shuffle(std::begin(cell_list), std::end(cell_list), mt);
+
+    // kept neighbor lists follow the cells to their new positions
+    if(neighborsValid){
+        std::vector<int> oldToNew(totalCells, -1);
+        for(int i=0; i<cell_list.size(); ++i){
+            oldToNew[cell_list[i].id] = i;
+        }
+        for(auto &cell : cell_list){
+            int *list = neighborIndices.data()+cell.neighborStart;
+            int k = 0;
+            for(int n=0; n<cell.neighborCount; ++n){
+                if(oldToNew[list[n]] != -1){
+                    list[k++] = oldToNew[list[n]];
+                }
+            }
+            cell.neighborCount = k;
+        }
+    }
+
+    for(int i=0; i<cell_list.size(); ++i){
+        cell_list[i].updateID(i);
+    }
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::inheritNeighbors(int parent) {
+    /*
+     * between neighbor rebuilds a daughter (the last cell) starts with its mother's neighbors and influences
+     * the mother sees the daughter right away, other cells once the lists are rebuilt
+     * both lists are appended to the end of the buffer, the mother's old slice is left unused until the rebuild
+     */
+    if(!neighborsValid){return;}
+    Cell<Dim> &mother = cell_list[parent];
+    Cell<Dim> &daughter = cell_list.back();
+    int idx = static_cast<int>(cell_list.size()) - 1;
+    int n = mother.neighborCount;
+    int start = static_cast<int>(neighborIndices.size());
+    neighborIndices.resize(start + 2*(n+1));
+    int *buffer = neighborIndices.data();
+
+    std::copy(buffer+mother.neighborStart, buffer+mother.neighborStart+n, buffer+start);
+    buffer[start+n] = parent;
+    std::copy(buffer+mother.neighborStart, buffer+mother.neighborStart+n, buffer+start+n+1);
+    buffer[start+2*n+1] = idx;
+
+    daughter.neighborStart = start;
+    daughter.neighborCount = n+1;
+    daughter.influences = mother.influences;
+    mother.neighborStart = start+n+1;
+    mother.neighborCount = n+1;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::updateMode() {
+    /*
+     * small tumors run each loop serially, since thread start-up costs more than the work
+     * once the population reaches parallelThreshold the loops are split across cores
+     */
+    parallel = static_cast<int>(cell_list.size()) >= options.parallelThreshold;
+}
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::runCells(double tstep) {
+    guardCore(tstep);
+    updateMode();
+    updateStepProbabilities(tstep);
+    for(auto &cell : cell_list){
+        cell.currentStep = steps;
+    }
+    exchangeHalo();
+    neighborInfluenceInteractions(tstep);
+    calculateForces(tstep);
+    dropHalo();
+    internalCellFunctions(tstep);
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
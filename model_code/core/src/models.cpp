@@ -0,0 +1,149 @@
+#include "Models.h"
+
+// *********
+// PDL1MODEL
+std::array<CellTypeParams, 2> PDL1Model::cellTypes(const std::vector<std::vector<double>> &cellParams) {
+    CellTypeParams cancer = {};
+    cancer.type = 0;
+
+    double diameter = cellParams[8][0];
+
+    cancer.mu = cellParams[0][0];
+    cancer.kc = cellParams[1][0];
+    cancer.damping = cellParams[2][0];
+    cancer.maxOverlap = cellParams[3][0]*diameter;
+    cancer.divProb = cellParams[4][0];
+    cancer.deathProb = cellParams[5][0];
+    cancer.pdl1WhenExpressed = cellParams[6][0];
+    cancer.pdl1Shift = cellParams[7][0];
+    cancer.radius = diameter/2.0;
+
+    cancer.rmax = 1.5*diameter;
+
+    // for influence distance, assume a soft-cutoff where p(distance) = probTh
+    cancer.probTh = 0.001;
+
+    CellTypeParams cd8 = {};
+    cd8.type = 1;
+
+    diameter = cellParams[11][1];
+
+    cd8.mu = cellParams[0][1];
+    cd8.kc = cellParams[1][1];
+    cd8.damping = cellParams[2][1];
+    cd8.maxOverlap = cellParams[3][1]*diameter;
+    cd8.deathProb = cellParams[4][1];
+    cd8.migrationSpeed = cellParams[5][1];
+    cd8.killProb = cellParams[6][1];
+    cd8.influenceRadius = cellParams[7][1];
+    cd8.infiltrationSD = cellParams[8][1]/3;
+    cd8.migrationBias = cellParams[9][1];
+    cd8.influenceDec = cellParams[10][1];
+    cd8.radius = diameter/2.0;
+
+    cd8.rmax = 1.5*diameter;
+
+    cd8.probTh = 0.001;
+    return {cancer, cd8};
+}
+
+template<int Dim>
+void PDL1Model::saveCells(const std::string &saveDir, const CellList<Dim> &cells) {
+    std::ofstream myfile;
+    myfile.open(saveDir+"/cancerCells.csv");
+    for(auto &cell : cells){
+        if(cell.type == 0) {
+            myfile << cell.x[0] << "," << cell.x[1] << "," << zOf(cell.x) << "," << cell.radius() << "," << cell.pdl1 << "," << cell.timeBorn << std::endl;
+        }
+    }
+    myfile.close();
+
+    myfile.open(saveDir+"/cd8Cells.csv");
+    for(auto &cell : cells){
+        if(cell.type == 1) {
+            int state = 0;
+            if (cell.state == 1) {
+                state = 0;
+            } else if (cell.state == 2) {
+                state = 1;
+            }
+            myfile << cell.x[0] << "," << cell.x[1] << "," << zOf(cell.x) << "," << cell.radius() << "," << state << "," << cell.infiltrationDistance << "," << cell.timeBorn << std::endl;
+        }
+    }
+    myfile.close();
+}
+// *********
+
+// ************
+// HYPOXIAMODEL
+std::array<CellTypeParams, 2> HypoxiaModel::cellTypes(const std::vector<std::vector<double>> &cellParams) {
+    CellTypeParams cancer = {};
+    cancer.type = 0;
+
+    double diameter = cellParams[6][0];
+
+    cancer.mu = cellParams[0][0];
+    cancer.kc = cellParams[1][0];
+    cancer.damping = cellParams[2][0];
+    cancer.maxOverlap = cellParams[3][0]*diameter;
+    cancer.divProb = cellParams[4][0];
+    cancer.deathProb = cellParams[5][0];
+    cancer.hypoxicL = cellParams[7][0];
+    cancer.hypoxicP = cellParams[8][0];
+    cancer.radius = diameter/2.0;
+
+    cancer.rmax = 1.5*diameter;
+
+    CellTypeParams cd8 = {};
+    cd8.type = 1;
+
+    diameter = cellParams[9][1];
+
+    cd8.mu = cellParams[0][1];
+    cd8.kc = cellParams[1][1];
+    cd8.damping = cellParams[2][1];
+    cd8.maxOverlap = cellParams[3][1]*diameter;
+    cd8.deathProb = cellParams[4][1];
+    cd8.migrationSpeed = cellParams[5][1];
+    cd8.killProb = cellParams[6][1];
+    cd8.infiltrationSD = cellParams[7][1]/3;
+    cd8.migrationBias = cellParams[8][1];
+    cd8.radius = diameter/2.0;
+
+    cd8.rmax = 1.5*diameter;
+    return {cancer, cd8};
+}
+
+template<int Dim>
+void HypoxiaModel::saveCells(const std::string &saveDir, const CellList<Dim> &cells) {
+    std::ofstream myfile;
+    myfile.open(saveDir+"/cancerAlive.csv");
+    for(auto &cell : cells){
+        if(cell.type == 0 && cell.state == 0) {
+            myfile << cell.x[0] << "," << cell.x[1] << "," << zOf(cell.x) << "," << cell.radius() << std::endl;
+        }
+    }
+    myfile.close();
+
+    myfile.open(saveDir+"/cancerDead.csv");
+    for(auto &cell : cells){
+        if(cell.type == 0 && cell.state == -1) {
+            myfile << cell.x[0] << "," << cell.x[1] << "," << zOf(cell.x) << "," << cell.radius() << std::endl;
+        }
+    }
+    myfile.close();
+
+    myfile.open(saveDir+"/cd8Cells.csv");
+    for(auto &cell : cells){
+        if(cell.type == 1) {
+            myfile << cell.x[0] << "," << cell.x[1] << "," << zOf(cell.x) << "," << cell.radius() << "," << cell.infiltrationDistance << std::endl;
+        }
+    }
+    myfile.close();
+}
+// ************
+
+template void PDL1Model::saveCells<2>(const std::string&, const CellList<2>&);
+template void PDL1Model::saveCells<3>(const std::string&, const CellList<3>&);
+template void HypoxiaModel::saveCells<2>(const std::string&, const CellList<2>&);
+template void HypoxiaModel::saveCells<3>(const std::string&, const CellList<3>&);
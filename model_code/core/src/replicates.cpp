@@ -0,0 +1,188 @@
+#include "Replicates.h"
+#include <climits>
+#include <cmath>
+
+template<class Model>
+static std::vector<DailyStats> replicateStats(std::string saveFld, std::shared_ptr<const Parameters> params, RunOptions opts,
+                                              int replicates, double tstep, int burnInSamples,
+                                              const std::function<void(EnvironmentBase&)> &configure) {
+    if(replicates < 1){
+        throw std::runtime_error("runReplicates -> need at least one replicate");
+    }
+
+    RunOptions run = opts;
+    run.verbose = false;
+    run.parallelThreshold = INT_MAX;
+
+    // cached tumors already skip construction, so only build the seed tumor when there is no cache
+    std::unique_ptr<EnvironmentBase> seed = EnvironmentBase::create<Model>(saveFld, params, run);
+    if(opts.burnInCache.empty()){
+        seed->initialize(tstep);
+    }
+
+    std::vector<std::vector<std::array<double, 5>>> outputs(replicates);
+    // state each replicate stopped in, and whether it went extinct (0) or was stopped by a criterion (1)
+    std::vector<std::array<double, 5>> finals(replicates);
+    std::vector<int> stopped(replicates, -1);
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int r=0; r<replicates; ++r){
+        std::string fld = saveFld+"/replicate_"+std::to_string(r);
+        std::string str = "mkdir -p "+fld;
+        std::system(str.c_str());
+
+        RunOptions own = run;
+        // replicates spread over the cached tumors
+        own.burnInSample = r%std::max(1, burnInSamples);
+        // with common random numbers replicate r of every parameter set uses the same seed
+        own.crnSeed = opts.crnSeed+r;
+        std::unique_ptr<EnvironmentBase> model = EnvironmentBase::create<Model>(fld, params, own);
+        if(configure){
+            configure(*model);
+        }
+        if(opts.burnInCache.empty()){
+            model->startFrom(*seed);
+        }
+        model->simulate(tstep);
+        outputs[r] = model->getDailyOutputs();
+        std::string reason = model->getStopReason();
+        bool extinct = reason == "no cancer cells";
+        finals[r] = {model->day(),
+                     extinct ? 0.0 : static_cast<double>(model->numCells(0)),
+                     static_cast<double>(model->numCells(1, 1)),
+                     static_cast<double>(model->numCells(1, 2)),
+                     extinct ? 0.0 : model->getTumorRadius()};
+        if(reason != "completed"){
+            stopped[r] = extinct ? 0 : 1;
+        }
+#pragma omp critical
+        if(opts.verbose){
+            std::cout << "replicate " << r << " finished: " << model->getStopReason() << std::endl;
+        }
+    }
+
+    /*
+     * per-day mean and sample variance over all replicates
+     * a replicate that stopped early keeps the state it stopped in (no cancer and radius 0 after extinction),
+     * so extinct and pruned trajectories stay in every later day instead of leaving only the survivors
+     */
+    int days = 0;
+    for(auto &out : outputs){
+        days = std::max(days, static_cast<int>(out.size()));
+    }
+    std::vector<double> dayOf(days);
+    for(auto &out : outputs){
+        for(int d=0; d<out.size(); ++d){
+            dayOf[d] = out[d][0];
+        }
+    }
+    auto row = [&](int r, int d) -> const std::array<double, 5>& {
+        return d < outputs[r].size() ? outputs[r][d] : finals[r];
+    };
+
+    std::vector<DailyStats> stats;
+    for(int d=0; d<days; ++d){
+        DailyStats s = {dayOf[d], replicates, 0, 0, {0,0,0,0}, {0,0,0,0}};
+        for(int r=0; r<replicates; ++r){
+            if(d >= outputs[r].size()){
+                (stopped[r] == 0 ? s.extinct : s.pruned)++;
+            }
+            for(int k=0; k<4; ++k){
+                s.mean[k] += row(r, d)[k+1];
+            }
+        }
+        for(int k=0; k<4; ++k){
+            s.mean[k] /= s.n;
+        }
+        for(int r=0; r<replicates; ++r){
+            for(int k=0; k<4; ++k){
+                s.var[k] += pow(row(r, d)[k+1]-s.mean[k], 2);
+            }
+        }
+        for(int k=0; k<4; ++k){
+            s.var[k] = s.n > 1 ? s.var[k]/(s.n-1) : 0.0;
+        }
+        stats.push_back(s);
+    }
+
+    std::ofstream myfile(saveFld+"/replicateStats.csv");
+    myfile << "day,n,extinct,pruned,cancer_mean,cancer_var,cd8Active_mean,cd8Active_var,"
+              "cd8Suppressed_mean,cd8Suppressed_var,radius_mean,radius_var" << std::endl;
+    for(auto &s : stats){
+        myfile << s.day << "," << s.n << "," << s.extinct << "," << s.pruned;
+        for(int k=0; k<4; ++k){
+            myfile << "," << s.mean[k] << "," << s.var[k];
+        }
+        myfile << std::endl;
+    }
+    myfile.close();
+
+    return stats;
+}
+
+template<class Model>
+std::vector<DailyStats> runReplicates(std::string saveFld, RunOptions opts, int replicates, double tstep, int burnInSamples,
+                                      const std::function<void(EnvironmentBase&)> &configure) {
+    return replicateStats<Model>(saveFld, Parameters::load<Model>(saveFld+"/params"), opts, replicates, tstep, burnInSamples, configure);
+}
+
+template<class Model>
+void calibrateFidelity(std::string saveFld, RunOptions opts, int maxLevel, int replicates, double tstep, int burnInSamples,
+                       const std::function<void(EnvironmentBase&)> &configure) {
+    std::shared_ptr<const Parameters> params = Parameters::load<Model>(saveFld+"/params");
+
+    std::vector<std::vector<DailyStats>> stats;
+    std::vector<double> times;
+    for(int level=0; level<=maxLevel; ++level){
+        std::string fld = saveFld+"/fidelity_"+std::to_string(level);
+        std::string str = "mkdir -p "+fld;
+        std::system(str.c_str());
+
+        RunOptions run = opts;
+        run.fidelity = level;
+        double start = omp_get_wtime();
+        stats.push_back(replicateStats<Model>(fld, params, run, replicates, tstep, burnInSamples, configure));
+        times.push_back(omp_get_wtime() - start);
+        if(opts.verbose){
+            std::cout << "fidelity " << level << ": " << times.back() << " s" << std::endl;
+        }
+    }
+
+    std::ofstream myfile(saveFld+"/fidelityCalibration.csv");
+    myfile << "level,seconds,speedup,cancer_relErr,cancer_z,cd8Active_relErr,cd8Active_z,"
+              "cd8Suppressed_relErr,cd8Suppressed_z,radius_relErr,radius_z" << std::endl;
+    const std::vector<DailyStats> &full = stats[0];
+    for(int level=0; level<=maxLevel; ++level){
+        std::array<double, 4> relErr = {0,0,0,0};
+        std::array<double, 4> z = {0,0,0,0};
+        int days = 0;
+        for(auto &s : stats[level]){
+            // compare on the days both levels reached
+            auto ref = std::find_if(full.begin(), full.end(), [&](const DailyStats &f){return f.day == s.day;});
+            if(ref == full.end()){
+                continue;
+            }
+            days++;
+            for(int k=0; k<4; ++k){
+                double diff = fabs(s.mean[k] - ref->mean[k]);
+                double se = sqrt(s.var[k]/s.n + ref->var[k]/ref->n);
+                relErr[k] += diff/std::max(fabs(ref->mean[k]), 1.0);
+                z[k] += se > 0 ? diff/se : 0.0;
+            }
+        }
+        myfile << level << "," << times[level] << "," << times[0]/times[level];
+        for(int k=0; k<4; ++k){
+            myfile << "," << (days > 0 ? relErr[k]/days : 0.0) << "," << (days > 0 ? z[k]/days : 0.0);
+        }
+        myfile << std::endl;
+    }
+    myfile.close();
+}
+
+template std::vector<DailyStats> runReplicates<PDL1Model>(std::string, RunOptions, int, double, int,
+                                                         const std::function<void(EnvironmentBase&)>&);
+template std::vector<DailyStats> runReplicates<HypoxiaModel>(std::string, RunOptions, int, double, int,
+                                                            const std::function<void(EnvironmentBase&)>&);
+template void calibrateFidelity<PDL1Model>(std::string, RunOptions, int, int, double, int,
+                                           const std::function<void(EnvironmentBase&)>&);
+template void calibrateFidelity<HypoxiaModel>(std::string, RunOptions, int, int, double, int,
+                                              const std::function<void(EnvironmentBase&)>&);
@@ -0,0 +1,55 @@
+#include "StoppingCriteria.h"
+
+template<int Dim, class Model>
+void Environment<Dim, Model>::addStoppingCriterion(std::shared_ptr<StoppingCriterion> criterion) {
+    stoppingCriteria.push_back(criterion);
+}
+
+template<int Dim, class Model>
+bool Environment<Dim, Model>::checkStoppingCriteria() {
+    // the first criterion that fails ends the run
+    for(auto &criterion : stoppingCriteria){
+        std::string reason = criterion->check(*this);
+        if(!reason.empty()){
+            stopReason = reason;
+            if(domain.rank() == 0){
+                std::cout << "Stopping: " << reason << std::endl;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+CellCountBounds::CellCountBounds(int minCancer, int maxCancer, int maxCD8):
+        minCancer(minCancer), maxCancer(maxCancer), maxCD8(maxCD8) {}
+
+std::string CellCountBounds::check(const EnvironmentBase &env) {
+    int numC = env.numCells(0);
+    int numT8 = env.numCells(1);
+
+    if(maxCancer >= 0 && numC > maxCancer){
+        return "cancer cells above " + std::to_string(maxCancer);
+    }
+    if(minCancer >= 0 && numC < minCancer){
+        return "cancer cells below " + std::to_string(minCancer);
+    }
+    if(maxCD8 >= 0 && numT8 > maxCD8){
+        return "CD8 above " + std::to_string(maxCD8);
+    }
+    return "";
+}
+
+TumorRadiusBound::TumorRadiusBound(double maxRadius): maxRadius(maxRadius) {}
+
+std::string TumorRadiusBound::check(const EnvironmentBase &env) {
+    if(env.getTumorRadius() > maxRadius){
+        return "tumor radius above " + std::to_string(maxRadius);
+    }
+    return "";
+}
+
+template class Environment<2, PDL1Model>;
+template class Environment<3, PDL1Model>;
+template class Environment<2, HypoxiaModel>;
+template class Environment<3, HypoxiaModel>;
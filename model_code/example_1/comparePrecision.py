@@ -0,0 +1,36 @@
+import csv
+import math
+import sys
+
+# compares the replicate statistics of a double build against a float (-DSINGLE_PRECISION) build
+# usage: python3 comparePrecision.py <double saveFld> <float saveFld>
+# both folders hold replicateStats.csv from ./main ... --replicates R
+# for every statistic prints the mean relative difference of the daily means
+# and the mean |difference|/standard error, where values near 1 or below are within replicate noise
+
+stats = ['cancer', 'cd8Active', 'cd8Suppressed', 'radius']
+
+
+def load(fld):
+    with open(fld + '/replicateStats.csv') as f:
+        return {float(row['day']): row for row in csv.DictReader(f)}
+
+
+ref = load(sys.argv[1])
+test = load(sys.argv[2])
+days = sorted(set(ref) & set(test))
+if not days:
+    sys.exit('no common days')
+
+print('statistic,relDiff,z')
+for s in stats:
+    relDiff = 0
+    z = 0
+    for d in days:
+        r = ref[d]
+        t = test[d]
+        diff = abs(float(t[s + '_mean']) - float(r[s + '_mean']))
+        se = math.sqrt(float(t[s + '_var']) / int(t['n']) + float(r[s + '_var']) / int(r['n']))
+        relDiff += diff / max(abs(float(r[s + '_mean'])), 1.0)
+        z += diff / se if se > 0 else 0.0
+    print(s + ',' + str(relDiff / len(days)) + ',' + str(z / len(days)))
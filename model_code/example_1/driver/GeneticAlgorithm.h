@@ -0,0 +1,100 @@
+#ifndef IMMUNE_MODEL_GENETICALGORITHM_H
+#define IMMUNE_MODEL_GENETICALGORITHM_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include "Environment.h"
+#include "Scorer.h"
+
+/*
+ * GENETIC ALGORITHM DRIVER
+ * ------------------------
+ * fits the model on one machine without a job scheduler
+ * each generation:
+ *  writes every individual's parameter files (a copy of the base parameters with the genes filled in)
+ *  runs the simulations in-process, spread over the cores (one simulation per core)
+ *  scores the generation's image batch with a Scorer
+ *  keeps the best individuals and breeds the rest by tournament selection, blend crossover, and mutation
+ *
+ * the population, scores, and generator state are saved after every generation, so a stopped fit resumes where it left off
+ */
+
+struct Gene{
+    // parameter file (cellParams, recParams, envParams), entry in it, and search range
+    std::string file;
+    int row;
+    int col;
+    double lower;
+    double upper;
+    // log-scaled genes are bred and mutated on log10(value)
+    bool logScale;
+};
+
+struct GAOptions{
+    int populationSize = 50;
+    int generations = 20;
+    int elites = 2;
+    int tournamentSize = 3;
+    double mutationRate = 0.2;
+    // standard deviation of a mutation, as a fraction of the gene's range
+    double mutationScale = 0.1;
+    unsigned int seed = 0;
+
+    // simulation folders and image batch
+    std::string workDir = "modelPredictions";
+    // population state, history, and timing
+    std::string stateDir = "fittingInfo";
+
+    double tstep = 0.25;
+    RunOptions runOptions;
+    int minCancer = -1;
+    int maxCancer = -1;
+    int maxCD8 = -1;
+
+    // the first lowFidelityGenerations generations run at this fidelity level (see RunOptions::fidelity)
+    // every generation is re-evaluated, so the population is promoted to full fidelity afterwards
+    int fidelity = 0;
+    int lowFidelityGenerations = 0;
+};
+
+class GeneticAlgorithm{
+public:
+    GeneticAlgorithm(std::vector<Gene> genes, std::string baseParams, GAOptions opts, Scorer &scorer);
+    void run();
+
+    static std::vector<Gene> loadGenes(std::string file);
+
+private:
+    void initializePopulation();
+    void evaluate();
+    void nextGeneration();
+    int tournament();
+
+    void writeParams(int idx, std::string saveFld);
+    std::vector<bool> runSimulations();
+
+    bool loadState();
+    void saveState();
+    void saveHistory(double simTime, double scoreTime);
+
+    double toGene(int g, double value);
+    double fromGene(int g, double value);
+
+    std::vector<Gene> genes;
+    GAOptions options;
+    Scorer &scorer;
+
+    // base parameter files, indexed by file name
+    std::vector<std::string> paramFiles;
+    std::vector<std::vector<std::vector<double>>> baseParams;
+
+    // population in parameter units
+    std::vector<std::vector<double>> population;
+    std::vector<double> scores;
+    int generation;
+
+    std::mt19937 mt;
+};
+
+#endif //IMMUNE_MODEL_GENETICALGORITHM_H
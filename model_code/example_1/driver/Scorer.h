@@ -0,0 +1,39 @@
+#ifndef IMMUNE_MODEL_SCORER_H
+#define IMMUNE_MODEL_SCORER_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <sys/types.h>
+
+/*
+ * scorers turn a generation of simulation images into distances from the target image
+ * batchFile is the (nSims, imSize, imSize, layers) .npy written with --image-batch
+ * lower scores are better
+ */
+
+class Scorer{
+public:
+    virtual ~Scorer() = default;
+    virtual std::vector<double> score(const std::string &batchFile, int nSims) = 0;
+};
+
+class PipeScorer : public Scorer{
+public:
+    /*
+     * keeps one scoring process (e.g. "python3 scoreServer.py 5") alive for the whole fit
+     * so the neural networks are loaded once
+     * protocol: one batch path per line on its stdin, answered by a line "scores,s0,s1,..." on its stdout
+     * any other output lines are ignored
+     */
+    explicit PipeScorer(std::string command);
+    ~PipeScorer() override;
+    std::vector<double> score(const std::string &batchFile, int nSims) override;
+
+private:
+    pid_t pid;
+    FILE *toScorer;
+    FILE *fromScorer;
+};
+
+#endif //IMMUNE_MODEL_SCORER_H
@@ -0,0 +1,74 @@
+#include <iostream>
+#include "GeneticAlgorithm.h"
+
+int main(int argc, char **argv) {
+    /*
+     * ./gaDriver <genes.csv> <baseParams folder> [options]
+     *  genes.csv lists the fitted entries of the parameter files (see GeneticAlgorithm::loadGenes)
+     *  baseParams holds cellParams.csv, recParams.csv and envParams.csv for everything that is not fitted
+     */
+    if(argc < 3){
+        std::cout << "usage: gaDriver <genes.csv> <baseParams folder> [options]" << std::endl;
+        return 1;
+    }
+    std::string genesFile = argv[1];
+    std::string baseFld = argv[2];
+
+    GAOptions opts;
+    opts.runOptions.imageGridSize = 20;
+    opts.runOptions.imageSize = 64;
+    std::string scoreCommand = "python3 scoreServer.py 5";
+    int threads = 0;
+    for(int i=3; i<argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--population" && i+1 < argc){
+            opts.populationSize = std::stoi(argv[++i]);
+        } else if(arg == "--generations" && i+1 < argc){
+            opts.generations = std::stoi(argv[++i]);
+        } else if(arg == "--elites" && i+1 < argc){
+            opts.elites = std::stoi(argv[++i]);
+        } else if(arg == "--mutation" && i+2 < argc){
+            opts.mutationRate = std::stod(argv[++i]);
+            opts.mutationScale = std::stod(argv[++i]);
+        } else if(arg == "--seed" && i+1 < argc){
+            opts.seed = std::stoul(argv[++i]);
+        } else if(arg == "--threads" && i+1 < argc){
+            threads = std::stoi(argv[++i]);
+        } else if(arg == "--scorer" && i+1 < argc){
+            scoreCommand = argv[++i];
+        } else if(arg == "--image" && i+2 < argc){
+            opts.runOptions.imageGridSize = std::stod(argv[++i]);
+            opts.runOptions.imageSize = std::stoi(argv[++i]);
+        } else if(arg == "--fidelity" && i+2 < argc){
+            opts.fidelity = std::stoi(argv[++i]);
+            opts.lowFidelityGenerations = std::stoi(argv[++i]);
+        } else if(arg == "--crn" && i+1 < argc){
+            opts.runOptions.commonRandomNumbers = true;
+            opts.runOptions.crnSeed = std::stoull(argv[++i]);
+        } else if(arg == "--burnin-cache" && i+1 < argc){
+            opts.runOptions.burnInCache = argv[++i];
+        } else if(arg == "--stop-min-cancer" && i+1 < argc){
+            opts.minCancer = std::stoi(argv[++i]);
+        } else if(arg == "--stop-max-cancer" && i+1 < argc){
+            opts.maxCancer = std::stoi(argv[++i]);
+        } else if(arg == "--stop-max-cd8" && i+1 < argc){
+            opts.maxCD8 = std::stoi(argv[++i]);
+        } else{
+            std::cout << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if(threads > 0){
+        omp_set_num_threads(threads);
+    }
+
+    PipeScorer scorer(scoreCommand);
+    GeneticAlgorithm ga(GeneticAlgorithm::loadGenes(genesFile), baseFld, opts, scorer);
+
+    double start = omp_get_wtime();
+    ga.run();
+    double stop = omp_get_wtime();
+    std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,386 @@
+#include "GeneticAlgorithm.h"
+#include "StoppingCriteria.h"
+#include "DiscreteImg.h"
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <cstdio>
+#include <climits>
+#include <map>
+
+static std::vector<std::vector<double>> readCSV(std::string file) {
+    std::ifstream data(file);
+    if(!data){
+        throw std::runtime_error("readCSV -> unable to open "+file);
+    }
+    std::vector<std::vector<double>> rows;
+    std::string line;
+    while(std::getline(data, line)){
+        std::stringstream lineStream(line);
+        std::string cell;
+        std::vector<double> parsedRow;
+        while(std::getline(lineStream, cell, ',')){
+            parsedRow.push_back(std::stod(cell));
+        }
+        rows.push_back(parsedRow);
+    }
+    return rows;
+}
+
+static void writeCSV(std::string file, const std::vector<std::vector<double>> &rows) {
+    std::ofstream out(file);
+    out << std::setprecision(17);
+    for(auto &row : rows){
+        for(int j=0; j<row.size(); ++j){
+            out << (j == 0 ? "" : ",") << row[j];
+        }
+        out << std::endl;
+    }
+}
+
+GeneticAlgorithm::GeneticAlgorithm(std::vector<Gene> genes, std::string baseFld, GAOptions opts, Scorer &scorer):
+        genes(genes), options(opts), scorer(scorer), mt(opts.seed == 0 ? (std::random_device())() : opts.seed) {
+    paramFiles = {"cellParams", "recParams", "envParams"};
+    for(auto &file : paramFiles){
+        baseParams.push_back(readCSV(baseFld+"/"+file+".csv"));
+    }
+
+    for(auto &gene : genes){
+        auto f = std::find(paramFiles.begin(), paramFiles.end(), gene.file);
+        if(f == paramFiles.end()){
+            throw std::runtime_error("GeneticAlgorithm::GeneticAlgorithm -> unknown parameter file "+gene.file);
+        }
+        auto &params = baseParams[f - paramFiles.begin()];
+        if(gene.row >= params.size() || gene.col >= params[gene.row].size()){
+            throw std::runtime_error("GeneticAlgorithm::GeneticAlgorithm -> gene outside of "+gene.file);
+        }
+        if(gene.logScale && gene.lower <= 0){
+            throw std::runtime_error("GeneticAlgorithm::GeneticAlgorithm -> log-scaled gene needs a positive range");
+        }
+    }
+
+    generation = 0;
+}
+
+std::vector<Gene> GeneticAlgorithm::loadGenes(std::string file) {
+    /*
+     * one gene per line: file,row,col,lower,upper,scale
+     * scale is lin or log, lines starting with # are skipped
+     */
+    std::ifstream data(file);
+    if(!data){
+        throw std::runtime_error("GeneticAlgorithm::loadGenes -> unable to open "+file);
+    }
+    std::vector<Gene> genes;
+    std::string line;
+    while(std::getline(data, line)){
+        if(line.empty() || line[0] == '#'){continue;}
+        std::stringstream lineStream(line);
+        std::vector<std::string> cells;
+        std::string cell;
+        while(std::getline(lineStream, cell, ',')){
+            cells.push_back(cell);
+        }
+        if(cells.size() != 6){
+            throw std::runtime_error("GeneticAlgorithm::loadGenes -> expected file,row,col,lower,upper,scale: "+line);
+        }
+        genes.push_back({cells[0], std::stoi(cells[1]), std::stoi(cells[2]),
+                         std::stod(cells[3]), std::stod(cells[4]), cells[5] == "log"});
+    }
+    return genes;
+}
+
+double GeneticAlgorithm::toGene(int g, double value) {
+    return genes[g].logScale ? log10(value) : value;
+}
+
+double GeneticAlgorithm::fromGene(int g, double value) {
+    return genes[g].logScale ? pow(10.0, value) : value;
+}
+
+void GeneticAlgorithm::run() {
+    std::string str = "mkdir -p "+options.stateDir+" "+options.workDir;
+    std::system(str.c_str());
+
+    if(loadState()){
+        std::cout << "Resuming after generation " << generation << std::endl;
+    } else{
+        initializePopulation();
+        generation = 0;
+        evaluate();
+        saveState();
+    }
+
+    while(generation + 1 < options.generations){
+        nextGeneration();
+        generation++;
+        evaluate();
+        saveState();
+    }
+
+    int best = std::min_element(scores.begin(), scores.end()) - scores.begin();
+    std::cout << "Best score: " << scores[best] << std::endl << "Parameters:";
+    for(double v : population[best]){
+        std::cout << " " << v;
+    }
+    std::cout << std::endl;
+}
+
+void GeneticAlgorithm::initializePopulation() {
+    // uniform over each gene's range (log-uniform for log-scaled genes)
+    population.assign(options.populationSize, std::vector<double>(genes.size()));
+    for(auto &individual : population){
+        for(int g=0; g<genes.size(); ++g){
+            std::uniform_real_distribution<double> dis(toGene(g, genes[g].lower), toGene(g, genes[g].upper));
+            individual[g] = fromGene(g, dis(mt));
+        }
+    }
+}
+
+void GeneticAlgorithm::evaluate() {
+    double start = omp_get_wtime();
+    std::vector<bool> valid = runSimulations();
+    double simulated = omp_get_wtime();
+
+    scores = scorer.score(options.workDir+"/simulations.npy", options.populationSize);
+    double scored = omp_get_wtime();
+
+    // failed, extinct, and pruned runs cannot be compared to the image
+    for(int i=0; i<scores.size(); ++i){
+        if(!valid[i]){
+            scores[i] = std::numeric_limits<double>::infinity();
+        }
+    }
+
+    saveHistory(simulated - start, scored - simulated);
+    std::cout << "Generation " << generation
+              << ": best " << *std::min_element(scores.begin(), scores.end())
+              << ", simulate " << simulated - start << " s"
+              << ", score " << scored - simulated << " s" << std::endl;
+}
+
+std::vector<bool> GeneticAlgorithm::runSimulations() {
+    /*
+     * one simulation per core, each run serially (see RunOptions::parallelThreshold)
+     * dynamic scheduling hands the next parameter set to whichever core finishes first
+     */
+    int n = options.populationSize;
+    std::string batch = options.workDir+"/simulations.npy";
+    std::remove(batch.c_str());
+    std::remove((batch+".ready").c_str());
+
+    std::vector<std::string> folders(n);
+    for(int i=0; i<n; ++i){
+        folders[i] = options.workDir+"/simulation_"+std::to_string(i)+"/set_0";
+        std::string str = "mkdir -p "+folders[i]+"/params";
+        std::system(str.c_str());
+        writeParams(i, folders[i]);
+    }
+
+    auto runOptions = [&](int i){
+        RunOptions run = options.runOptions;
+        run.verbose = false;
+        run.parallelThreshold = INT_MAX;
+        run.fidelity = generation < options.lowFidelityGenerations ? options.fidelity : 0;
+        run.imageBatch = batch;
+        run.imageSlot = i;
+        run.imageSlots = n;
+        return run;
+    };
+
+    /*
+     * individuals sharing a burn-in entry (all of them, unless genes change cancer parameters) start from one tumor
+     * it is loaded or grown here, one entry at a time, so parallel runs never grow the same entry side by side
+     */
+    std::map<std::string, std::unique_ptr<EnvironmentBase>> burnIns;
+    std::vector<const EnvironmentBase*> seeds(n, nullptr);
+    std::vector<std::string> failures(n);
+    if(!options.runOptions.burnInCache.empty()){
+        for(int i=0; i<n; ++i){
+            try{
+                std::unique_ptr<EnvironmentBase> model = EnvironmentBase::create<PDL1Model>(folders[i], runOptions(i));
+                std::unique_ptr<EnvironmentBase> &seed = burnIns[model->burnInEntry(options.tstep)];
+                if(!seed){
+                    model->initialize(options.tstep);
+                    seed = std::move(model);
+                }
+                seeds[i] = seed.get();
+            } catch(std::exception &e){
+                failures[i] = e.what();
+            }
+        }
+    }
+
+    std::vector<int> completed(n, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int i=0; i<n; ++i){
+        RunOptions run = runOptions(i);
+        try{
+            if(!failures[i].empty()){
+                throw std::runtime_error(failures[i]);
+            }
+            std::unique_ptr<EnvironmentBase> model = EnvironmentBase::create<PDL1Model>(folders[i], run);
+            if(options.minCancer >= 0 || options.maxCancer >= 0 || options.maxCD8 >= 0){
+                model->addStoppingCriterion(std::make_shared<CellCountBounds>(options.minCancer, options.maxCancer, options.maxCD8));
+            }
+            if(seeds[i]){
+                model->startFrom(*seeds[i]);
+            }
+            model->simulate(options.tstep);
+            completed[i] = model->getStopReason() == "completed";
+        } catch(std::exception &e){
+            // keep the batch complete so the scorer does not wait on this slot
+            std::vector<size_t> shape = {static_cast<size_t>(run.imageSize), static_cast<size_t>(run.imageSize), 4};
+            DiscreteImg::saveNpySlot(batch, i, n, std::vector<double>(shape[0]*shape[1]*shape[2], 0.0), shape, 2);
+#pragma omp critical
+            std::cout << "simulation " << i << " failed: " << e.what() << std::endl;
+        }
+    }
+
+    return std::vector<bool>(completed.begin(), completed.end());
+}
+
+void GeneticAlgorithm::writeParams(int idx, std::string saveFld) {
+    std::vector<std::vector<std::vector<double>>> params = baseParams;
+    for(int g=0; g<genes.size(); ++g){
+        int f = std::find(paramFiles.begin(), paramFiles.end(), genes[g].file) - paramFiles.begin();
+        params[f][genes[g].row][genes[g].col] = population[idx][g];
+    }
+    for(int f=0; f<paramFiles.size(); ++f){
+        writeCSV(saveFld+"/params/"+paramFiles[f]+".csv", params[f]);
+    }
+}
+
+int GeneticAlgorithm::tournament() {
+    std::uniform_int_distribution<int> pick(0, options.populationSize-1);
+    int best = pick(mt);
+    for(int k=1; k<options.tournamentSize; ++k){
+        int other = pick(mt);
+        if(scores[other] < scores[best]){
+            best = other;
+        }
+    }
+    return best;
+}
+
+void GeneticAlgorithm::nextGeneration() {
+    /*
+     * elites carry over unchanged
+     * children take each gene from a blend (BLX-0.5) of two tournament winners, then mutate with a gaussian step
+     */
+    std::vector<int> order(options.populationSize);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b){return scores[a] < scores[b];});
+
+    std::vector<std::vector<double>> next;
+    for(int e=0; e<options.elites && e<order.size(); ++e){
+        next.push_back(population[order[e]]);
+    }
+
+    std::uniform_real_distribution<double> unif(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    while(next.size() < options.populationSize){
+        auto &p1 = population[tournament()];
+        auto &p2 = population[tournament()];
+        std::vector<double> child(genes.size());
+        for(int g=0; g<genes.size(); ++g){
+            double lower = toGene(g, genes[g].lower);
+            double upper = toGene(g, genes[g].upper);
+            double a = toGene(g, p1[g]);
+            double b = toGene(g, p2[g]);
+            double d = fabs(a - b);
+            double v = std::min(a, b) - 0.5*d + unif(mt)*2*d;
+            if(unif(mt) < options.mutationRate){
+                v += normal(mt)*options.mutationScale*(upper - lower);
+            }
+            child[g] = fromGene(g, std::min(std::max(v, lower), upper));
+        }
+        next.push_back(child);
+    }
+
+    population = next;
+    scores.assign(options.populationSize, 0.0);
+}
+
+bool GeneticAlgorithm::loadState() {
+    /*
+     * gaState.csv: the last evaluated generation number, then one row per individual (genes..., score)
+     * gaRng.txt: generator state after that generation
+     */
+    std::ifstream data(options.stateDir+"/gaState.csv");
+    if(!data){return false;}
+
+    std::string line;
+    std::getline(data, line);
+    int savedGeneration = std::stoi(line);
+    std::vector<std::vector<double>> rows;
+    while(std::getline(data, line)){
+        std::stringstream lineStream(line);
+        std::string cell;
+        std::vector<double> parsedRow;
+        while(std::getline(lineStream, cell, ',')){
+            parsedRow.push_back(std::stod(cell));
+        }
+        rows.push_back(parsedRow);
+    }
+    if(rows.size() != options.populationSize){
+        throw std::runtime_error("GeneticAlgorithm::loadState -> saved population has a different size");
+    }
+
+    population.clear();
+    scores.clear();
+    for(auto &row : rows){
+        if(row.size() != genes.size()+1){
+            throw std::runtime_error("GeneticAlgorithm::loadState -> saved population has different genes");
+        }
+        population.push_back(std::vector<double>(row.begin(), row.end()-1));
+        scores.push_back(row.back());
+    }
+
+    std::ifstream rng(options.stateDir+"/gaRng.txt");
+    if(rng){
+        rng >> mt;
+    }
+    generation = savedGeneration;
+    return true;
+}
+
+void GeneticAlgorithm::saveState() {
+    // written to temporary files and renamed, so an interrupted save keeps the previous state
+    std::string stateFile = options.stateDir+"/gaState.csv";
+    std::ofstream out(stateFile+".tmp");
+    out << generation << std::endl << std::setprecision(17);
+    for(int i=0; i<population.size(); ++i){
+        for(double v : population[i]){
+            out << v << ",";
+        }
+        out << scores[i] << std::endl;
+    }
+    out.close();
+
+    std::string rngFile = options.stateDir+"/gaRng.txt";
+    std::ofstream rng(rngFile+".tmp");
+    rng << mt;
+    rng.close();
+
+    std::rename((rngFile+".tmp").c_str(), rngFile.c_str());
+    std::rename((stateFile+".tmp").c_str(), stateFile.c_str());
+
+    // same layout as the python pipeline's parameter file
+    writeCSV(options.stateDir+"/paramsModel.csv", population);
+}
+
+void GeneticAlgorithm::saveHistory(double simTime, double scoreTime) {
+    std::ofstream history(options.stateDir+"/gaHistory.csv", std::ios::app);
+    history << std::setprecision(17);
+    for(int i=0; i<population.size(); ++i){
+        history << generation << "," << i;
+        for(double v : population[i]){
+            history << "," << v;
+        }
+        history << "," << scores[i] << std::endl;
+    }
+
+    std::ofstream timing(options.stateDir+"/gaTiming.csv", std::ios::app);
+    timing << generation << "," << simTime << "," << scoreTime << "," << simTime + scoreTime << std::endl;
+}
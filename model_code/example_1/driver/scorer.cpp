@@ -0,0 +1,71 @@
+#include "Scorer.h"
+#include <stdexcept>
+#include <sstream>
+#include <iostream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+PipeScorer::PipeScorer(std::string command) {
+    int toChild[2];
+    int fromChild[2];
+    if(pipe(toChild) != 0 || pipe(fromChild) != 0){
+        throw std::runtime_error("PipeScorer::PipeScorer -> unable to create pipes");
+    }
+
+    pid = fork();
+    if(pid < 0){
+        throw std::runtime_error("PipeScorer::PipeScorer -> unable to start "+command);
+    }
+    if(pid == 0){
+        dup2(toChild[0], STDIN_FILENO);
+        dup2(fromChild[1], STDOUT_FILENO);
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    close(toChild[0]);
+    close(fromChild[1]);
+    toScorer = fdopen(toChild[1], "w");
+    fromScorer = fdopen(fromChild[0], "r");
+}
+
+PipeScorer::~PipeScorer() {
+    // closing stdin ends the scoring process
+    fclose(toScorer);
+    fclose(fromScorer);
+    waitpid(pid, nullptr, 0);
+}
+
+std::vector<double> PipeScorer::score(const std::string &batchFile, int nSims) {
+    fprintf(toScorer, "%s\n", batchFile.c_str());
+    fflush(toScorer);
+
+    std::string line;
+    char buffer[4096];
+    while(fgets(buffer, sizeof(buffer), fromScorer) != nullptr){
+        line += buffer;
+        if(line.back() != '\n'){continue;}
+        if(line.rfind("scores,", 0) == 0){
+            break;
+        }
+        line.clear();
+    }
+    if(line.rfind("scores,", 0) != 0){
+        throw std::runtime_error("PipeScorer::score -> scoring process exited");
+    }
+
+    std::vector<double> scores;
+    std::stringstream lineStream(line.substr(7));
+    std::string cell;
+    while(std::getline(lineStream, cell, ',')){
+        scores.push_back(std::stod(cell));
+    }
+    if(static_cast<int>(scores.size()) != nSims){
+        throw std::runtime_error("PipeScorer::score -> expected "+std::to_string(nSims)+" scores, got "+std::to_string(scores.size()));
+    }
+    return scores;
+}
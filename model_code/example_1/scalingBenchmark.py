@@ -0,0 +1,60 @@
+import hashlib
+import os
+import subprocess
+import sys
+import time
+
+# strong scaling of one run over OpenMP thread counts
+# usage (from example_1, next to main and genParams.py): python3 scalingBenchmark.py <folder> <paramSet> [maxThreads]
+# runs ./main <folder> <paramSet> 0 --crn 1 --parallel-threshold 0 --thread-timing with 1, 2, 4, ... threads up to
+# maxThreads (default: all cores), so the largest counts span every socket
+# threads are pinned with OMP_PLACES=cores OMP_PROC_BIND=spread unless these are already set
+# prints threads, wall seconds, speed-up, parallel efficiency and the slowest/mean thread balance of the force loop,
+# and checks that every thread count produced the same cells, which --crn guarantees
+# the table is also written to <folder>/simulation_<paramSet>/scaling.csv
+
+folder = sys.argv[1]
+paramSet = sys.argv[2]
+maxThreads = int(sys.argv[3]) if len(sys.argv) > 3 else os.cpu_count()
+
+counts = []
+n = 1
+while n < maxThreads:
+    counts.append(n)
+    n *= 2
+counts.append(maxThreads)
+
+env = dict(os.environ)
+env.setdefault('OMP_PLACES', 'cores')
+env.setdefault('OMP_PROC_BIND', 'spread')
+print('OMP_PLACES=' + env['OMP_PLACES'] + ' OMP_PROC_BIND=' + env['OMP_PROC_BIND'])
+
+saveFld = folder + '/simulation_' + paramSet + '/set_0'
+rows = []
+reference = None
+for threads in counts:
+    env['OMP_NUM_THREADS'] = str(threads)
+    start = time.time()
+    out = subprocess.run(['./main', folder, paramSet, '0', '--crn', '1', '--parallel-threshold', '0', '--thread-timing'],
+                         env=env, capture_output=True, text=True, check=True).stdout
+    seconds = time.time() - start
+
+    balance = ''
+    for line in out.splitlines():
+        if line.startswith('Thread balance'):
+            words = line.split()
+            balance = words[words.index('forces') + 1]
+    with open(saveFld + '/cancerCells.csv', 'rb') as f:
+        cells = hashlib.md5(f.read()).hexdigest()
+    if reference is None:
+        reference = cells
+        base = seconds
+    rows.append([threads, seconds, base / seconds, base / seconds / threads, balance, cells == reference])
+
+print('threads,seconds,speedup,efficiency,forceBalance,sameCells')
+with open(folder + '/simulation_' + paramSet + '/scaling.csv', 'w') as f:
+    f.write('threads,seconds,speedup,efficiency,forceBalance,sameCells\n')
+    for row in rows:
+        line = ','.join(str(v) for v in row)
+        print(line)
+        f.write(line + '\n')
@@ -1,11 +1,101 @@
 #include <iostream>
 #include "Environment.h"
+#include "StoppingCriteria.h"
+#include "Replicates.h"
 
 int main(int argc, char **argv) {
     std::string folder = argv[1];
     std::string paramSet = argv[2];
     std::string set = argv[3];
 
+    // optional run settings follow the three positional arguments
+    RunOptions opts;
+    std::string restartFile;
+    int burnInSamples = 1;
+    int minCancer = -1;
+    int maxCancer = -1;
+    int maxCD8 = -1;
+    double maxRadius = -1;
+    int replicates = 0;
+    int calibrateLevels = -1;
+    for(int i=4; i<argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--parallel-threshold" && i+1 < argc){
+            opts.parallelThreshold = std::stoi(argv[++i]);
+        } else if(arg == "--checkpoint-every" && i+1 < argc){
+            opts.checkpointInterval = std::stoi(argv[++i]);
+        } else if(arg == "--restart" && i+1 < argc){
+            restartFile = argv[++i];
+        } else if(arg == "--burnin-cache" && i+1 < argc){
+            opts.burnInCache = argv[++i];
+        } else if(arg == "--burnin-samples" && i+1 < argc){
+            burnInSamples = std::stoi(argv[++i]);
+        } else if(arg == "--image" && i+2 < argc){
+            opts.imageGridSize = std::stod(argv[++i]);
+            opts.imageSize = std::stoi(argv[++i]);
+        } else if(arg == "--image-batch" && i+2 < argc){
+            opts.imageBatch = argv[++i];
+            opts.imageSlots = std::stoi(argv[++i]);
+        } else if(arg == "--stop-min-cancer" && i+1 < argc){
+            minCancer = std::stoi(argv[++i]);
+        } else if(arg == "--stop-max-cancer" && i+1 < argc){
+            maxCancer = std::stoi(argv[++i]);
+        } else if(arg == "--stop-max-cd8" && i+1 < argc){
+            maxCD8 = std::stoi(argv[++i]);
+        } else if(arg == "--stop-max-radius" && i+1 < argc){
+            maxRadius = std::stod(argv[++i]);
+        } else if(arg == "--crn" && i+1 < argc){
+            opts.commonRandomNumbers = true;
+            opts.crnSeed = std::stoull(argv[++i]);
+        } else if(arg == "--fidelity" && i+1 < argc){
+            opts.fidelity = std::stoi(argv[++i]);
+        } else if(arg == "--domain-cutoff" && i+1 < argc){
+            opts.domainCutoff = std::stod(argv[++i]);
+        } else if(arg == "--daily-center"){
+            opts.dailyTumorCenter = true;
+        } else if(arg == "--edge-interval" && i+1 < argc){
+            opts.edgeInterval = std::stoi(argv[++i]);
+        } else if(arg == "--static-chunks"){
+            opts.staticChunks = true;
+        } else if(arg == "--thread-timing"){
+            opts.threadTiming = true;
+        } else if(arg == "--event-timers"){
+            opts.eventTimers = true;
+        } else if(arg == "--hybrid-core" && i+1 < argc){
+            opts.coreDepth = std::stod(argv[++i]);
+        } else if(arg == "--calibrate-fidelity" && i+1 < argc){
+            calibrateLevels = std::stoi(argv[++i]);
+        } else if(arg == "--replicates" && i+1 < argc){
+            replicates = std::stoi(argv[++i]);
+        } else{
+            std::cout << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    // replicates spread over the cached tumors
+    opts.burnInSample = std::stoi(set) % burnInSamples;
+    // batch images are stored at the parameter set's index
+    opts.imageSlot = std::stoi(paramSet);
+    if(!opts.imageBatch.empty() && (opts.imageGridSize <= 0 || opts.imageSize <= 0)){
+        std::cout << "--image-batch needs --image with a fixed image size" << std::endl;
+        return 1;
+    }
+    if((replicates > 0 || calibrateLevels >= 0) && (!opts.imageBatch.empty() || !restartFile.empty())){
+        std::cout << "--replicates and --calibrate-fidelity cannot be combined with --image-batch or --restart" << std::endl;
+        return 1;
+    }
+
+    // under mpirun the run is split over the ranks (built with -DUSE_MPI), rank 0 prepares the folder
+    Domain::start(argc, argv);
+    Domain world;
+    if(world.distributed() && (replicates > 0 || calibrateLevels >= 0)){
+        if(world.rank() == 0){
+            std::cout << "--replicates and --calibrate-fidelity run on a single rank" << std::endl;
+        }
+        Domain::stop();
+        return 1;
+    }
+
     std::string saveFld = "./"+folder+"/simulation_"+paramSet+"/set_"+set;
     std::string str = "mkdir -p "+saveFld;
 
@@ -17,18 +107,51 @@ int main(int argc, char **argv) {
         saveFld = "./"+folder+"_"+paramSet+"/set_"+set;
     }*/
 
-    const char *command = str.c_str();
-    std::system(command);
+    if(world.rank() == 0){
+        const char *command = str.c_str();
+        std::system(command);
 
-    str = "python3 genParams.py "+paramSet+" "+saveFld;
-    command = str.c_str();
-    std::system(command);
+        str = "python3 genParams.py "+paramSet+" "+saveFld;
+        command = str.c_str();
+        std::system(command);
+    }
+    world.barrier();
 
     double start = omp_get_wtime();
-    Environment model(saveFld);
-    model.simulate(0.25);
+    auto addCriteria = [&](EnvironmentBase &model){
+        if(minCancer >= 0 || maxCancer >= 0 || maxCD8 >= 0){
+            model.addStoppingCriterion(std::make_shared<CellCountBounds>(minCancer, maxCancer, maxCD8));
+        }
+        if(maxRadius >= 0){
+            model.addStoppingCriterion(std::make_shared<TumorRadiusBound>(maxRadius));
+        }
+    };
+    if(calibrateLevels >= 0){
+        calibrateFidelity<PDL1Model>(saveFld, opts, calibrateLevels, std::max(replicates, 4), 0.25, burnInSamples, addCriteria);
+        double stop = omp_get_wtime();
+        std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+        Domain::stop();
+        return 0;
+    }
+    if(replicates > 0){
+        runReplicates<PDL1Model>(saveFld, opts, replicates, 0.25, burnInSamples, addCriteria);
+        double stop = omp_get_wtime();
+        std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+        Domain::stop();
+        return 0;
+    }
+
+    std::unique_ptr<EnvironmentBase> model = EnvironmentBase::create<PDL1Model>(saveFld, opts);
+    addCriteria(*model);
+    if(!restartFile.empty()){
+        model->loadCheckpoint(restartFile);
+    }
+    model->simulate(0.25);
     double stop = omp_get_wtime();
-    std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+    if(world.rank() == 0){
+        std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+    }
 
+    Domain::stop();
     return 0;
 }
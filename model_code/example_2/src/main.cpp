@@ -6,20 +6,30 @@ int main(int argc, char **argv) {
     std::string paramSet = argv[2];
     std::string set = argv[3];
 
+    // under mpirun the run is split over the ranks (built with -DUSE_MPI), rank 0 prepares the folder
+    Domain::start(argc, argv);
+    Domain world;
+
     std::string saveFld = "./"+folder+"/simulation_"+paramSet+"/set_"+set;
     std::string str;
-    const char *command = str.c_str();
-    std::system(command);
+    if(world.rank() == 0){
+        const char *command = str.c_str();
+        std::system(command);
 
-    str = "python3 genParams.py "+paramSet+" "+saveFld+" "+folder;
-    command = str.c_str();
-    std::system(command);
+        str = "python3 genParams.py "+paramSet+" "+saveFld+" "+folder;
+        command = str.c_str();
+        std::system(command);
+    }
+    world.barrier();
 
     double start = omp_get_wtime();
-    Environment model(saveFld);
-    model.simulate(0.25);
+    std::unique_ptr<EnvironmentBase> model = EnvironmentBase::create<HypoxiaModel>(saveFld);
+    model->simulate(0.25);
     double stop = omp_get_wtime();
-    std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+    if(world.rank() == 0){
+        std::cout << "Duration: " << (stop-start)/(60*60) << std::endl;
+    }
 
+    Domain::stop();
     return 0;
 }
@@ -0,0 +1,43 @@
+'''
+long-running version of calculateScores.py for the C++ genetic algorithm driver (model_code/example_1/driver)
+
+input
+-----
+- nModels: number of neural networks in the ensemble
+
+loads the ensemble and projects the target image (modelPredictions/base.npy) once
+then, for every simulation batch path read from stdin:
+    projects the batch (see simulationBatch.py) with each network
+    averages the euclidean distance to the image over the ensemble
+    answers with one line: scores,d0,d1,...
+'''
+
+import os
+import sys
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import numpy as np
+from genNN import loadModel
+from simulationBatch import loadBatch
+
+nModels = int(sys.argv[1])
+
+models = [loadModel('sn_models/projector/model_'+str(m)) for m in range(nModels)]
+
+base = np.load('modelPredictions/base.npy', allow_pickle=True)
+base = np.reshape(base, [1] + list(base.shape))
+pointsBase = [np.reshape(model.predict(base, verbose=0), [1, -1]) for model in models]
+
+for line in sys.stdin:
+    path = line.strip()
+    if path == '':
+        continue
+
+    sims, ready = loadBatch(path)
+    distances = np.zeros(sims.shape[0])
+    for model, pointBase in zip(models, pointsBase):
+        points = model.predict(np.asarray(sims), verbose=0)
+        distances += np.sqrt(np.sum((points - pointBase)**2, axis=1))
+    distances /= nModels
+
+    print('scores,' + ','.join(str(d) for d in distances), flush=True)
@@ -0,0 +1,34 @@
+'''
+reads the image batch written by the C++ models with --image-batch
+
+the models write each simulation's image straight into its slot of one preallocated .npy file
+(shape (nSims, imSize, imSize, layers)), and set byte i of <file>.ready once slot i is filled
+    1 - image written
+    2 - the simulation ended without cancer cells, the slot is all zeros
+
+loadBatch(path, timeout)
+------------------------
+- waits until every slot is filled, then memory-maps the array (no copy, no per-simulation parsing)
+- files without a .ready companion (e.g. written by format_simulations.py) are loaded normally
+- output: the array and the ready flags (None for normally loaded files)
+'''
+
+import numpy as np
+import os
+import time
+
+def loadBatch(path, timeout=None, poll=1.0):
+    readyFile = path + '.ready'
+    if not os.path.exists(readyFile):
+        return np.load(path, allow_pickle=True), None
+
+    start = time.time()
+    while True:
+        ready = np.fromfile(readyFile, dtype=np.uint8)
+        if ready.size > 0 and np.all(ready > 0):
+            break
+        if timeout is not None and time.time() - start > timeout:
+            exit('simulation batch not finished: ' + str(np.sum(ready == 0)) + ' slots missing')
+        time.sleep(poll)
+
+    return np.load(path, mmap_mode='r'), ready